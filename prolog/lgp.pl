@@ -5,7 +5,9 @@
  * @export
  *
  * create_dictionary/5 : this predicate loads a dictionary from the disk and sets up the memory structures accordingly
+ * create_dictionary/2 : same as create_dictionary/5, with the files and the knowledge to load given as a list of options (post_process(false), constituents(false)...)
  * delete_dictionary/1 : this predicate deletes a dictionary from the memory
+ * reload_dictionary/1 : load the files of a dictionary again behind the same handle (existing sentences keep the previous version until they are deleted)
  * delete_all_dictionaries/0 : delete all the recorded dictionaries from the memory
  * get_nb_dictionaries/1 : get the number of dictionaries currently in the memory
  * get_handles_dictionaries/1 : get a list containing all the exiting handles of allocated dictionaries
@@ -19,6 +21,7 @@
  * get_handles_parse_options/1 : get a list containing all the exiting handles of allocated parse option objects
  * get_handles_nb_references_parse_options/2 : get two lists associating the exiting handles of allocated parse options to the count other object references
  * create_linkage_set/3 : this predicate creates a linkage set, gathering a sentence with its parse options
+ * reparse_linkage_set/3 : parse the sentence of a linkage set again with some of its parse options changed (for instance a higher max_null_count), reusing what its previous parses learnt
  * delete_linkage_set/1 : this predicate deletes a linkage set from the memory
  * delete_all_linkage_sets/0 : delete all the recorded linkage sets from the memory
  * get_nb_linkage_sets/1 : get the number of linkage sets currently in the memory
@@ -27,7 +30,10 @@
  * get_num_linkages/2 : get the number of linkages available from a linkage set object
  * get_parameters_for_linkage_set/2 : return a list containing all the handles and values associated to a linkage set object
  * get_full_info_linkage_sets/1 : give the complete list of parameters for all the existing linkage sets
- * create_sentence/3 : this predicate creates a sentence and tokenises it accordingly to a dictionary
+ * get_linkage_set_statistics/2 : get the measures (parse time, memory, linkages found...) taken while parsing the sentence of a linkage set
+ * sentence_accepts/3 : check whether a sentence can be parsed with some parse options (and get its null count and best costs) without creating a linkage set
+ * estimate_parse_cost/3 : predict the cost of parsing a sentence (number of words, number of disjuncts after pruning and time class) without parsing it
+ * create_sentence/3 : this predicate creates a sentence (given as an atom, a string or a code list) and tokenises it accordingly to a dictionary
  * delete_sentence/1 : this predicate deletes a sentence object from the memory
  * delete_all_sentences/0 : delete all the recorded sentences from the memory
  * get_nb_sentences/1 : get the number of sentence objects currently in the memory
@@ -37,12 +43,37 @@
  * enable_panic_on_parse_options/1 : this predicate activates panic mode on a parse options structure
  * disable_panic_on_parse_options/1 : this predicate deactivates panic mode on a parse options structure
  * get_linkage/2 : this is the foreign predicate making the link with the Link Grammar Parser's API
+ * get_linkage/3 : same as get_linkage/2, with a list of output options (word_format(functor|string), connector_format(compound|string), format(links|compact), fields(List) to only build some of the domains, words and labels)
+ * get_linkages/4, get_linkages/5 : extract a range of linkages from a linkage set in one call (get_linkages/5 takes output options)
+ * get_all_linkages/2, get_all_linkages/3 : extract all the linkages of a linkage set in one call (get_all_linkages/3 takes output options)
+ * get_linkage_compact/2 : same as get_linkage/2, but returns each linkage as a word vector and a list of l(Left_index, Right_index, Label_id, Domain_mask) links
+ * get_best_linkages/3, get_best_linkages/4 : get the K cheapest linkages of a linkage set, the cheapest first (get_best_linkages/4 takes output options)
+ * connector_label/2 : convert a connector label id (as returned by get_linkage_compact/2) into the connector label, or the other way round for a label already output in the compact format
+ * start_workers/2 : fork worker processes that parse sentences with a dictionary, isolating the Prolog process from lgp library crashes
+ * stop_workers/0 : stop the worker processes started by start_workers/2
+ * get_worker_pids/1 : get the process ids of the worker processes
+ * worker_parse/2 : parse a sentence with the worker processes and get its linkages one by one on backtracking
+ * worker_parse_batch/2 : parse a list of sentences with the worker processes, in parallel
+ * worker_parse_batch/3 : same as worker_parse_batch/2, with a list of options (cost_lanes(true) to parse the expensive sentences on a separate worker, cost_classes(Classes) to get the lane of each sentence)
+ * parse_submit/5 : submit the parse of a sentence to the worker processes, with a priority class (interactive, normal or bulk) and a deadline, without waiting for it
+ * parse_wait/2 : wait for a parse job submitted by parse_submit/5 and get its linkages
+ * parse_cancel/1 : delete a parse job submitted by parse_submit/5 without waiting for it
+ * set_parse_class_limit/2 : set the largest number of workers that the parse jobs of a priority class can use at the same time
+ * get_parse_queue_statistics/1 : get the queue depth, running jobs, deadline misses, preemptions and stolen jobs of each priority class of parse jobs
+ * create_pipeline/2 : create a bounded pipeline through which a stream of sentences is parsed by the worker processes (options capacity(N), when_full(block|fail), priority(Class), parse_options(Handle))
+ * pipeline_push/2 : push a sentence into a pipeline, waiting (or failing) while it is full
+ * pipeline_pop/2 : get the linkages of the oldest sentence of a pipeline, waiting for it if needed
+ * close_pipeline/1 : mark the end of the stream of a pipeline, pipeline_pop/2 fails once it is empty
+ * delete_pipeline/1 : delete a pipeline and the sentences it still contains
+ * with_parse_session/1 : run a goal and delete all the objects it created when it exits
 **/
 
 :- module(lgp,
 	  [
 	   create_dictionary/5,
+	   create_dictionary/2,
 	   delete_dictionary/1,
+	   reload_dictionary/1,
 	   delete_all_dictionaries/0,
 	   get_nb_dictionaries/1,
            get_handles_dictionaries/1,
@@ -56,6 +87,7 @@
            get_handles_parse_options/1,
            get_handles_nb_references_parse_options/2,
 	   create_linkage_set/3,
+	   reparse_linkage_set/3,
 	   delete_linkage_set/1,
 	   delete_all_linkage_sets/0,
 	   get_nb_linkage_sets/1,
@@ -64,6 +96,9 @@
 	   get_num_linkages/2,
            get_parameters_for_linkage_set/2,
            get_full_info_linkage_sets/1,
+           get_linkage_set_statistics/2,
+           sentence_accepts/3,
+           estimate_parse_cost/3,
 	   create_sentence/3,
 	   delete_sentence/1,
 	   delete_all_sentences/0,
@@ -73,11 +108,39 @@
 	   get_max_sentence/1,
 	   enable_panic_on_parse_options/1,
 	   disable_panic_on_parse_options/1,
-	   get_linkage/2
+	   get_linkage/2,
+	   get_linkage/3,
+	   get_linkages/4,
+	   get_linkages/5,
+	   get_all_linkages/2,
+	   get_all_linkages/3,
+	   get_linkage_compact/2,
+	   get_best_linkages/3,
+	   get_best_linkages/4,
+	   connector_label/2,
+	   start_workers/2,
+	   stop_workers/0,
+	   get_worker_pids/1,
+	   worker_parse/2,
+	   worker_parse_batch/2,
+	   worker_parse_batch/3,
+	   parse_submit/5,
+	   parse_wait/2,
+	   parse_cancel/1,
+	   set_parse_class_limit/2,
+	   get_parse_queue_statistics/1,
+	   create_pipeline/2,
+	   pipeline_push/2,
+	   pipeline_pop/2,
+	   close_pipeline/1,
+	   delete_pipeline/1,
+	   with_parse_session/1
 	  ]).
 
 :- use_module(library(shlib)).
 
+:- meta_predicate with_parse_session(0).
+
 :- use_foreign_library(foreign(lgp), install_lgp).
 
 /**
@@ -94,6 +157,37 @@
 get_handles_dictionaries(Handles_list):-
 	get_handles_nb_references_dictionaries(Handles_list, _).
 
+/**
+ * @name create_dictionary/2
+ * @mode create_dictionary(+, -)
+ *
+ * @usage
+ * create_dictionary(Option_list, Dictionary_handle).
+ *
+ * @description
+ * This predicate creates a new dictionary like create_dictionary/5 and unifies Dictionary_handle with a handle on this new dictionary
+ * The files are taken from Option_list: dictionary(File), knowledge(File), constituent_knowledge(File), affix(File). Defaults are the 4.0.* files of the lgp library
+ * post_process(false) and constituents(false) prevent loading the post processing knowledge and the constituent knowledge respectively. Without post processing knowledge, linkages have no domains (they are left unbound in the linkage compounds)
+ * post_process(false) is the way to get raw links: the linkages found are neither checked nor given domains by post-processing, which saves the memory of the knowledge and the post-processing time of each linkage
+**/
+
+create_dictionary(Option_list, Dictionary_handle):-
+	(   memberchk(dictionary(Dictionary_name), Option_list) -> true ; Dictionary_name='4.0.dict' ),
+	(   memberchk(post_process(false), Option_list)
+	->  Pp_knowledge_name=''
+	;   memberchk(knowledge(Pp_knowledge_name), Option_list)
+	->  true
+	;   Pp_knowledge_name='4.0.knowledge'
+	),
+	(   memberchk(constituents(false), Option_list)
+	->  Cons_knowledge_name=''
+	;   memberchk(constituent_knowledge(Cons_knowledge_name), Option_list)
+	->  true
+	;   Cons_knowledge_name='4.0.constituent-knowledge'
+	),
+	(   memberchk(affix(Affix_name), Option_list) -> true ; Affix_name='4.0.affix' ),
+	create_dictionary(Dictionary_name, Pp_knowledge_name, Cons_knowledge_name, Affix_name, Dictionary_handle).
+
 /**
  * @name create_parse_options/2
  * @mode create_parse_options(+, -)
@@ -118,6 +212,7 @@ create_parse_options(Option_list, Parse_options_handle):-
  *
  * @description
  * This predciate sets the options in the Parse_options_handle object, accordingly to the Option_list
+ * max_memory=Bytes is the memory the lgp library may allocate for each parse. A parse exceeding it is aborted, then retried with panic settings if panic_mode=true, otherwise lgp_api_error(parse, memory_exceeded) is raised
 **/
 
 set_parse_options(Parse_options_handle, Option_list):-
@@ -326,6 +421,33 @@ get_full_info_linkage_sets_([Head_handle|Tail_Handle_list], [Head_information|Ta
 	get_full_info_linkage_sets_(Tail_Handle_list, Tail_information_list).
 get_full_info_linkage_sets_([], []).
 
+/**
+ * @name reparse_linkage_set/3
+ * @mode reparse_linkage_set(+, +, -)
+ *
+ * @usage
+ * reparse_linkage_set(Linkage_set_handle, Option_overlay, New_linkage_set_handle).
+ *
+ * @description
+ * This predicate creates a new linkage set from the sentence of Linkage_set_handle, parsed with the parse options of Linkage_set_handle changed by Option_overlay (same format as for set_parse_options/2)
+ * The null counts that the previous parses of the sentence with the same options (apart from min_null_count and max_null_count) found to give no linkage are not tried again
+ * This is a plain parse of the sentence: apart from skipping these null counts, nothing is reused from the previous parses, as the lgp library keeps no disjunct nor counting table from one parse to another
+ * The new linkage set holds a private copy of its parse options, deleted together with it (get_parameters_for_linkage_set/2 gives parse_options_handle=none for it). Like create_linkage_set/3, this predicate fails if the sentence has no linkage with these options
+ * A parse options object is created for the time of the call to apply Option_overlay: when the limit of parse options objects held at the same time is reached (see get_nb_parse_options/1), lgp_api_error(parse_options, too_many) is raised, as by create_parse_options/2
+ * Linkage_set_handle keeps its own parse, so linkages can still be got from both linkage sets. The text of the sentence is tokenized again for the new parse while Linkage_set_handle exists, as a parse held by the lgp library can't be shared
+**/
+
+reparse_linkage_set(Linkage_set_handle, Option_overlay, New_linkage_set_handle):-
+	create_parse_options_(New_parse_options_handle),
+	(   catch(( copy_linkage_set_parse_options_(Linkage_set_handle, New_parse_options_handle),
+		    set_parse_options(New_parse_options_handle, Option_overlay),
+		    reparse_linkage_set_(Linkage_set_handle, New_parse_options_handle, New_linkage_set_handle)
+		  ), Exception, (delete_parse_options(New_parse_options_handle), throw(Exception)))
+	->  delete_parse_options(New_parse_options_handle)
+	;   delete_parse_options(New_parse_options_handle),
+	    fail
+	).
+
 /**
  * @name get_handles_linkage_sets/1
  * @mode get_handles_linkage_sets(-)
@@ -353,3 +475,165 @@ get_handles_linkage_sets(Handles_list):-
 
 get_handles_sentences(Handles_list):-
 	get_handles_nb_references_sentences(Handles_list, _).
+
+/**
+ * @name get_linkages/4
+ * @mode get_linkages(+, +, +, -)
+ *
+ * @usage
+ * get_linkages(Linkage_set_handle, From, Count, Linkage_list).
+ *
+ * @description
+ * This predicate returns the list of at most Count linkages of a linkage set, starting from linkage number From (0-based), with the default output format
+**/
+
+get_linkages(Linkage_set_handle, From, Count, Linkage_list):-
+	get_linkages(Linkage_set_handle, From, Count, [], Linkage_list).
+
+/**
+ * @name get_all_linkages/2, get_all_linkages/3
+ * @mode get_all_linkages(+, -), get_all_linkages(+, +, -)
+ *
+ * @usage
+ * get_all_linkages(Linkage_set_handle, Linkage_list).
+ * get_all_linkages(Linkage_set_handle, Output_options, Linkage_list).
+ *
+ * @description
+ * This predicate returns the list of all the linkages of a linkage set (in the same order as get_linkage/2 would enumerate them)
+ * This is equivalent to findall/3 on get_linkage/2 (or get_linkage/3 with Output_options), but all linkages are extracted in a single foreign call
+**/
+
+get_all_linkages(Linkage_set_handle, Linkage_list):-
+	get_all_linkages(Linkage_set_handle, [], Linkage_list).
+get_all_linkages(Linkage_set_handle, Output_options, Linkage_list):-
+	get_num_linkages(Linkage_set_handle, Num_linkages),
+	get_linkages(Linkage_set_handle, 0, Num_linkages, Output_options, Linkage_list).
+
+/**
+ * @name get_linkage_compact/2
+ * @mode get_linkage_compact(+, -)
+ *
+ * @usage
+ * get_linkage_compact(Linkage_set_handle, compact(Words, Links)).
+ *
+ * @description
+ * This predicate enumerates the linkages of a linkage set like get_linkage/2, but in the compact format:
+ * Words is a words/N compound containing each word of the sentence (as a string) once, and Links a list of l(Left_index, Right_index, Label_id, Domain_mask) terms
+ * connector_label/2 converts Label_id back to the connector label
+ * error(resource_error(connector_table), _) is raised if a connector label can't be given a Label_id (the table of connector labels is full)
+**/
+
+get_linkage_compact(Linkage_set_handle, Compact_linkage):-
+	get_linkage(Linkage_set_handle, [format(compact)], Compact_linkage).
+
+/**
+ * @name get_best_linkages/3
+ * @mode get_best_linkages(+, +, -)
+ *
+ * @usage
+ * get_best_linkages(Linkage_set_handle, K, Linkage_list).
+ *
+ * @description
+ * This predicate returns the list of the K cheapest linkages of a linkage set (or all of them if there are less than K), the cheapest first, with the default output format
+ * Costs are compared on the disjunct cost first, then on the total link length
+**/
+
+get_best_linkages(Linkage_set_handle, K, Linkage_list):-
+	get_best_linkages(Linkage_set_handle, K, [], Linkage_list).
+
+/**
+ * @name worker_parse/2
+ * @mode worker_parse(+, -)
+ *
+ * @usage
+ * worker_parse(Sentence, Linkage).
+ *
+ * @description
+ * This predicate parses Sentence with one of the worker processes started by start_workers/2, and unifies Linkage with each of its linkages on backtracking, in the same format as get_linkage/2
+ * If the worker crashes while parsing the sentence, it is restarted and lgp_api_error(sentence, worker_crashed) is raised
+**/
+
+worker_parse(Sentence, Linkage):-
+	worker_parse_batch([Sentence], [Linkage_list]),
+	member(Linkage, Linkage_list).
+
+/**
+ * @name worker_parse_batch/2
+ * @mode worker_parse_batch(+, -)
+ *
+ * @usage
+ * worker_parse_batch(Sentence_list, Linkage_lists).
+ *
+ * @description
+ * This predicate parses all the sentences of Sentence_list with the worker processes started by start_workers/2, in parallel, and unifies Linkage_lists with the list of the linkage lists of these sentences (each linkage in the format of get_linkage/2)
+ * Sentences are given to the workers in the order of the list, as soon as a worker is idle
+**/
+
+worker_parse_batch(Sentence_list, Linkage_lists):-
+	worker_parse_batch(Sentence_list, [], Linkage_lists).
+
+/**
+ * @name worker_parse_batch/3
+ * @mode worker_parse_batch(+, +, -)
+ *
+ * @usage
+ * worker_parse_batch(Sentence_list, Options, Linkage_lists).
+ *
+ * @description
+ * Same as worker_parse_batch/2, with a list of options:
+ * cost_lanes(Bool) : false by default. With cost_lanes(true) and more than one worker, the cost of each sentence is estimated first by the workers, as with estimate_parse_cost/3: the last worker parses the expensive sentences (and cheaper ones once none is left), the other workers parse the cheap and medium ones first, then steal the last expensive sentences
+ * cost_classes(Classes) : Classes is unified with the estimated cost class of each sentence (cheap, medium or expensive), the expensive ones being those of the expensive lane. It is unknown for the sentences that have not been estimated
+**/
+
+worker_parse_batch(Sentence_list, Options, Linkage_lists):-
+	(   memberchk(cost_lanes(true), Options)
+	->  Cost_lanes = 1
+	;   Cost_lanes = 0
+	),
+	worker_parse_batch_(Sentence_list, Cost_lanes, Linkage_lists, Cost_classes),
+	(   memberchk(cost_classes(Classes), Options)
+	->  Classes = Cost_classes
+	;   true
+	).
+
+/**
+ * @name create_pipeline/2
+ * @mode create_pipeline(+, -)
+ *
+ * @usage
+ * create_pipeline(Options, Pipeline).
+ *
+ * @description
+ * This predicate creates a bounded pipeline feeding the worker processes started by start_workers/2: sentences pushed by pipeline_push/2 are tokenised and parsed by the workers, and their linkages are converted back into terms by pipeline_pop/2, in push order
+ * Options is a list of:
+ * capacity(N) : at most N sentences are in the pipeline, pushed and not yet popped (64 by default)
+ * when_full(block|fail) : pipeline_push/2 waits for a consumer when the pipeline is full (block, the default), or fails
+ * priority(Class) : priority class of the parse jobs of the pipeline, see parse_submit/5 (normal by default)
+ * parse_options(Parse_options_handle) : parse options of the sentences, as they are when the pipeline is created (the default parse options of the workers otherwise)
+ * Producers and consumers can be different threads, the library mutex being released while they wait
+**/
+
+create_pipeline(Options, Pipeline):-
+	(   memberchk(capacity(Capacity), Options) -> true ; Capacity = 64 ),
+	(   memberchk(when_full(When_full), Options) -> true ; When_full = block ),
+	(   memberchk(priority(Priority), Options) -> true ; Priority = normal ),
+	(   memberchk(parse_options(Parse_options), Options) -> true ; Parse_options = default ),
+	create_pipeline_(Capacity, When_full, Priority, Parse_options, Pipeline).
+
+/**
+ * @name with_parse_session/1
+ * @mode with_parse_session(:)
+ *
+ * @usage
+ * with_parse_session(Goal).
+ *
+ * @description
+ * This predicate runs once(Goal) in a new parse session: all the dictionaries, parse options, sentences and linkage sets created by the calling thread while Goal runs are deleted when it exits, by success, failure or exception
+ * This is done in one pass over each object list, instead of deleting the objects one by one. Handles created inside the session must thus not be used after it
+ * Sessions can be nested, objects of an inner session that are still referenced by objects of the enclosing one are deleted with the enclosing session
+**/
+
+with_parse_session(Goal):-
+	setup_call_cleanup(begin_parse_session_(Parent_session, Session),
+			   once(Goal),
+			   end_parse_session_(Session, Parent_session)).
@@ -0,0 +1,172 @@
+/**
+ * @modulename lgp_remote.pl
+ *
+ * Client of the lgp-server parse server (see src/lgp-server.c), which parses sentences in separate processes with a dictionary loaded once
+ * The linkages are returned in the same format as get_linkage/2 in lgp.pl
+ *
+ * Exported predicates:
+ * @export
+ *
+ * connect/2 : open a connection to an lgp-server listening on a Unix-domain socket
+ * disconnect/1 : close a connection opened by connect/2
+ * parse/3 : parse a sentence on the server and get its linkages one by one on backtracking
+ * parse_batch/3 : parse a list of sentences on the server, keeping a bounded number of requests in flight
+**/
+
+:- module(lgp_remote,
+	  [
+	   connect/2,
+	   disconnect/1,
+	   parse/3,
+	   parse_batch/3
+	  ]).
+
+:- use_module(library(socket)).
+:- use_module(library(utf8)).
+
+request_type(parse, 1).
+
+% Maximum number of requests sent by parse_batch/3 before the first answer is read
+% The server answers the requests of a connection in order and blocks when the socket buffer of its answers is full, so the client has to read answers while it sends requests
+batch_window(32).
+
+response_status(0, ok).
+response_status(1, lgp_api_error(sentence, too_long)).
+response_status(2, lgp_api_error(sentence, cant_register)).
+response_status(3, lgp_api_error(server, bad_request)).
+response_status(4, lgp_api_error(server, not_enough_memory)).
+
+/**
+ * @name connect/2
+ * @mode connect(+, -)
+ *
+ * @usage
+ * connect(Socket_path, Connection).
+ *
+ * @description
+ * This predicate connects to the lgp-server listening on the Unix-domain socket Socket_path and unifies Connection with a handle on this connection
+**/
+
+connect(Socket_path, lgp_connection(Stream)):-
+	unix_domain_socket(Socket),
+	catch(tcp_connect(Socket, Socket_path), Exc, (tcp_close_socket(Socket), throw(Exc))),
+	tcp_open_socket(Socket, Stream),
+	set_stream(Stream, type(binary)).
+
+/**
+ * @name disconnect/1
+ * @mode disconnect(+)
+ *
+ * @usage
+ * disconnect(Connection).
+ *
+ * @description
+ * This predicate closes a connection opened by connect/2
+**/
+
+disconnect(lgp_connection(Stream)):-
+	close(Stream, [force(true)]).
+
+/**
+ * @name parse/3
+ * @mode parse(+, +, -)
+ *
+ * @usage
+ * parse(Connection, Sentence, Linkage).
+ *
+ * @description
+ * This predicate parses Sentence (an atom, a string or a code list) on the server and unifies Linkage with each of its linkages on backtracking, in the same format and order as get_linkage/2
+ * It fails if the sentence has no linkage, and raises the same lgp_api_error(sentence, ...) exceptions as create_linkage_set/3
+**/
+
+parse(Connection, Sentence, Linkage):-
+	parse_batch(Connection, [Sentence], [Linkage_list]),
+	member(Linkage, Linkage_list).
+
+/**
+ * @name parse_batch/3
+ * @mode parse_batch(+, +, -)
+ *
+ * @usage
+ * parse_batch(Connection, Sentence_list, Linkage_lists).
+ *
+ * @description
+ * This predicate parses all the sentences of Sentence_list on the server and unifies Linkage_lists with the list of the linkage lists of these sentences
+ * Up to batch_window/1 requests are sent before the first answer is read, then one answer is read for each new request sent, so that the server does not wait for the client between two sentences, and neither the client nor the server can block on a full socket buffer whatever the size of the batch
+ * If one sentence raises an error, all the answers are still read (so that the connection can be used again) and the error of the first such sentence is raised
+**/
+
+parse_batch(lgp_connection(Stream), Sentence_list, Linkage_lists):-
+	batch_window(Window),
+	length(Sentence_list, Nb_sentences),
+	Nb_first is min(Window, Nb_sentences),
+	length(First_sentences, Nb_first),
+	append(First_sentences, Next_sentences, Sentence_list),
+	forall(member(Sentence, First_sentences), put_request(Stream, Sentence)),
+	flush_output(Stream),
+	send_and_read_responses(Next_sentences, Stream, Responses, Last_responses),
+	read_responses(First_sentences, Stream, Last_responses),
+	(   memberchk(error(Error), Responses)
+	->  throw(Error)
+	;   findall(Linkage_list, member(linkages(Linkage_list), Responses), Linkage_lists)
+	).
+
+% send_and_read_responses(+Sentence_list, +Stream, -Responses, ?Tail)
+% Sends one request for each sentence of Sentence_list, reading the oldest answer in flight before each of them
+% Responses is the difference list (ending with Tail) of these answers, which are those of the first requests of the batch
+send_and_read_responses([], _, Responses, Responses).
+send_and_read_responses([Sentence|Sentence_list], Stream, [Response|Responses], Tail):-
+	read_response(Stream, Response),
+	put_request(Stream, Sentence),
+	flush_output(Stream),
+	send_and_read_responses(Sentence_list, Stream, Responses, Tail).
+
+put_request(Stream, Sentence):-
+	request_type(parse, Request_type),
+	text_to_string(Sentence, Sentence_string),
+	string_codes(Sentence_string, Codes),
+	phrase(utf8_codes(Codes), Bytes),
+	length(Bytes, Length),
+	Frame_length is Length+4,
+	put_uint32(Stream, Frame_length),
+	put_uint32(Stream, Request_type),
+	forall(member(Byte, Bytes), put_byte(Stream, Byte)).
+
+read_responses([], _, []).
+read_responses([_|Sentence_list], Stream, [Response|Responses]):-
+	read_response(Stream, Response),
+	read_responses(Sentence_list, Stream, Responses).
+
+read_response(Stream, Response):-
+	get_uint32(Stream, Frame_length),
+	get_uint32(Stream, Status),
+	Length is Frame_length-4,
+	length(Bytes, Length),
+	maplist(get_byte_checked(Stream), Bytes),
+	(   response_status(Status, ok)
+	->  phrase(utf8_codes(Codes), Bytes),
+	    string_codes(String, Codes),
+	    term_string(Linkage_list, String),
+	    Response=linkages(Linkage_list)
+	;   response_status(Status, Error)
+	->  Response=error(Error)
+	;   Response=error(lgp_api_error(server, bad_response))
+	).
+
+put_uint32(Stream, Value):-
+	B3 is (Value>>24) /\ 0xff,
+	B2 is (Value>>16) /\ 0xff,
+	B1 is (Value>>8) /\ 0xff,
+	B0 is Value /\ 0xff,
+	put_byte(Stream, B3), put_byte(Stream, B2), put_byte(Stream, B1), put_byte(Stream, B0).
+
+get_uint32(Stream, Value):-
+	get_byte_checked(Stream, B3), get_byte_checked(Stream, B2), get_byte_checked(Stream, B1), get_byte_checked(Stream, B0),
+	Value is (B3<<24) \/ (B2<<16) \/ (B1<<8) \/ B0.
+
+get_byte_checked(Stream, Byte):-
+	get_byte(Stream, Byte),
+	(   Byte == -1
+	->  throw(lgp_api_error(server, connection_lost))
+	;   true
+	).
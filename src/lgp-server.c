@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "link-includes.h"
+#include "lgp-worker.h"
+
+/**
+ * @modulename lgp-server.c
+ *
+ * @description
+ * Standalone parse server for the lgp library. The dictionary is loaded once, then a pool of worker processes is forked and serves parse requests on a Unix-domain socket
+ * Workers are separate processes sharing the dictionary copy-on-write, so that an lgp library crash on one sentence only kills one worker, which is restarted by the supervisor (the main process)
+ * Each worker accepts one connection at a time, and answers the requests of this connection in order. Clients can thus send several requests before reading the answers (pipelining)
+ *
+ * The protocol and the parse itself are implemented in lgp-worker.c (see lgp-worker.h)
+ * See prolog/lgp_remote.pl for the Prolog client
+ *
+ * Usage: lgp-server [-w Nb_workers] [-l Linkage_limit] Socket_path [Dictionary Post_processing Constituents Affix]
+**/
+
+#if (defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32))
+#error lgp-server relies on Unix-domain sockets and fork(), so it cannot be built on Windows
+#endif
+
+#define DEFAULT_NB_WORKERS 4 /* Number of worker processes when -w is not given */
+#define MAX_NB_WORKERS 64
+
+static volatile sig_atomic_t stop_requested=0; /* Set by the SIGINT and SIGTERM handler of the supervisor */
+
+
+/**
+ * @name static void run_worker(int listen_fd, Dictionary dict, Parse_Options opts)
+ *
+ * @description
+ * This is the body of each worker process: it accepts connections on the listening socket shared by all workers, and serves them one after the other. It never returns
+**/
+
+static void run_worker(int listen_fd, Dictionary dict, Parse_Options opts) {
+
+int fd;
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  while (1) {
+    if ((fd = accept(listen_fd, NULL, NULL)) < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      exit(1);
+    }
+    lgp_worker_serve(fd, dict, opts);
+    close(fd);
+  }
+}
+
+
+/**
+ * @name static pid_t start_worker(int listen_fd, Dictionary dict, Parse_Options opts)
+ *
+ * @description
+ * This function forks a new worker process and returns its pid (or -1 if fork() failed)
+**/
+
+static pid_t start_worker(int listen_fd, Dictionary dict, Parse_Options opts) {
+
+pid_t pid = fork();
+
+  if (pid == 0) run_worker(listen_fd, dict, opts);
+  return pid;
+}
+
+
+static void stop_handler(int signal_number) {
+  stop_requested = 1;
+}
+
+
+static void usage(char *program_name) {
+  fprintf(stderr, "Usage: %s [-w Nb_workers] [-l Linkage_limit] Socket_path [Dictionary Post_processing Constituents Affix]\n", program_name);
+  fprintf(stderr, "An empty Post_processing, Constituents or Affix file name disables the corresponding knowledge\n");
+  exit(2);
+}
+
+
+/**
+ * @name main(int argc, char **argv)
+ *
+ * @description
+ * The main process loads the dictionary, opens the listening socket and forks the workers. It then supervises them: a worker that dies (for instance because the lgp library crashed on a sentence) is replaced by a new one
+ * The server stops on SIGINT or SIGTERM, killing the workers and removing the socket file
+**/
+
+int main(int argc, char **argv) {
+
+int                nb_workers = DEFAULT_NB_WORKERS;
+int                linkage_limit = 100;
+int                option;
+char               *socket_path;
+char               *file_name[4] = {"4.0.dict", "4.0.knowledge", "4.0.constituent-knowledge", "4.0.affix"};
+int                i;
+Dictionary         dict;
+Parse_Options      opts;
+int                listen_fd;
+struct sockaddr_un address;
+pid_t              worker[MAX_NB_WORKERS];
+pid_t              pid;
+struct sigaction   action;
+
+  while ((option = getopt(argc, argv, "w:l:")) != -1) {
+    switch (option) {
+    case 'w':
+      nb_workers = atoi(optarg);
+      if (nb_workers < 1 || nb_workers > MAX_NB_WORKERS) usage(argv[0]);
+      break;
+    case 'l':
+      linkage_limit = atoi(optarg);
+      if (linkage_limit < 1) usage(argv[0]);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (argc - optind != 1 && argc - optind != 5) usage(argv[0]);
+  socket_path = argv[optind];
+  if (argc - optind == 5)
+    for (i=0; i<4; i++) file_name[i] = argv[optind+1+i];
+  if (strlen(socket_path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "%s: socket path too long\n", argv[0]);
+    return 1;
+  }
+
+  dict = dictionary_create(file_name[0],
+                           (*file_name[1] != '\0' ? file_name[1] : NULL),
+                           (*file_name[2] != '\0' ? file_name[2] : NULL),
+                           (*file_name[3] != '\0' ? file_name[3] : NULL));
+  if (dict == NULL) {
+    fprintf(stderr, "%s: can't load dictionary %s\n", argv[0], file_name[0]);
+    return 1;
+  }
+  if ((opts = lgp_worker_create_parse_options(linkage_limit)) == NULL) {
+    fprintf(stderr, "%s: can't create parse options\n", argv[0]);
+    return 1;
+  }
+
+  if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    perror("socket");
+    return 1;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socket_path);
+  unlink(socket_path); /* Remove a socket file left by a previous server */
+  if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listen_fd, 64) < 0) {
+    perror(socket_path);
+    return 1;
+  }
+
+  signal(SIGPIPE, SIG_IGN); /* A client closing its connection early must not kill the worker */
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop_handler; /* No SA_RESTART, so that waitpid() below is interrupted */
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  for (i=0; i<nb_workers; i++) worker[i] = start_worker(listen_fd, dict, opts);
+
+  while (!stop_requested) { /* Supervise the workers */
+    pid = waitpid(-1, NULL, 0);
+    if (pid < 0) {
+      if (errno == EINTR) continue;
+      sleep(1); /* No worker running (fork() failed), try again below */
+    }
+    for (i=0; i<nb_workers && !stop_requested; i++) {
+      if (worker[i] == pid || worker[i] < 0) {
+        worker[i] = start_worker(listen_fd, dict, opts);
+      }
+    }
+  }
+
+  for (i=0; i<nb_workers; i++)
+    if (worker[i] > 0) kill(worker[i], SIGTERM);
+  while (waitpid(-1, NULL, 0) > 0 || errno == EINTR);
+  close(listen_fd);
+  unlink(socket_path);
+  parse_options_delete(opts);
+  dictionary_delete(dict);
+  return 0;
+}
@@ -0,0 +1,539 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include "link-includes.h"
+#include "prune.h"
+#include "lgp-worker.h"
+
+/**
+ * @modulename lgp-worker.c
+ *
+ * @description
+ * Parse worker shared by lgp-server (see lgp-server.c) and the worker processes of the lgp foreign library (see start_workers/2 in lgp.c)
+ * A worker reads parse requests from a file descriptor and answers them in order, using the protocol described in lgp-worker.h
+ * The linkages are sent back as the Prolog text of a list, in the same format as get_linkage/2, so that the client only has to read this text as a term
+**/
+
+
+/**
+ * @name static void count_expression_disjuncts(Exp *e, int cost_cutoff, double *count)
+ *
+ * @description
+ * This procedure computes the number of disjuncts the expression e expands to, without building them: count[c] receives the number of disjuncts of cost c, for c from 0 to cost_cutoff
+ * The expansion is the one of the lgp library when it builds disjuncts: an OR gives the union of its operands, an AND the product of its operands (the costs being added), and disjuncts costing more than cost_cutoff are dropped
+ * Counts are doubles, as the expressions of some words expand to a huge number of disjuncts
+**/
+
+static void count_expression_disjuncts(Exp *e, int cost_cutoff, double *count) {
+
+double child_count[LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST+1]; /* Disjunct counts of one operand of e */
+double product[LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST+1]; /* Disjunct counts of the operands of an AND processed so far */
+E_list *operand;
+int    own_cost = (e->cost > 0 ? e->cost : 0);
+int    c, c1;
+
+  for (c=0; c<=cost_cutoff; c++) count[c] = 0.0;
+  if (own_cost > cost_cutoff) return;
+  switch (e->type) {
+  case CONNECTOR_type:
+    count[own_cost] = 1.0;
+    break;
+  case OR_type:
+    for (operand = e->u.l; operand != NULL; operand = operand->next) {
+      count_expression_disjuncts(operand->e, cost_cutoff-own_cost, child_count);
+      for (c=0; c<=cost_cutoff-own_cost; c++) count[c+own_cost] += child_count[c];
+    }
+    break;
+  case AND_type:
+    count[own_cost] = 1.0; /* The empty AND is one disjunct without connector */
+    for (operand = e->u.l; operand != NULL; operand = operand->next) {
+      count_expression_disjuncts(operand->e, cost_cutoff, child_count);
+      for (c=0; c<=cost_cutoff; c++) product[c] = 0.0;
+      for (c=0; c<=cost_cutoff; c++) {
+        if (count[c] == 0.0) continue;
+        for (c1=0; c+c1<=cost_cutoff; c1++) product[c+c1] += count[c] * child_count[c1];
+      }
+      for (c=0; c<=cost_cutoff; c++) count[c] = product[c];
+    }
+    break;
+  }
+}
+
+
+/**
+ * @name double lgp_worker_estimate_disjuncts(Sentence sent, int cost_cutoff)
+ *
+ * @description
+ * This function runs the expression pruning of the lgp library on sent (the first step of sentence_parse(), that the next parse runs again anyway) and returns the total number of disjuncts of all its words with a disjunct cost up to cost_cutoff
+ * This is the number of disjuncts sentence_parse() starts from, before removing duplicates and running the power pruning. cost_cutoff is bounded by LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST
+ * It is used by estimate_parse_cost/3 in lgp.c, and by the workers for LGP_WORKER_REQUEST_ESTIMATE requests
+**/
+
+double lgp_worker_estimate_disjuncts(Sentence sent, int cost_cutoff) {
+
+double  count[LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST+1];
+double  nb_disjuncts = 0.0;
+X_node  *x;
+int     w, c;
+
+  if (cost_cutoff > LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST) cost_cutoff = LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST;
+  if (cost_cutoff < 0) cost_cutoff = 0;
+  expression_prune(sent);
+  for (w=0; w<sent->length; w++) {
+    for (x = sent->word[w].x; x != NULL; x = x->next) {
+      count_expression_disjuncts(x->exp, cost_cutoff, count);
+      for (c=0; c<=cost_cutoff; c++) nb_disjuncts += count[c];
+    }
+  }
+  return nb_disjuncts;
+}
+
+
+
+#if !(defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32)) /* Workers are forked processes, which Windows doesn't provide */
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+static int max_sentence_length=70; /* Same values as in lgp.c */
+static int min_short_sent_len=20;
+
+
+/**
+ * @name static int buffer_append(text_buffer *buffer, const char *string, size_t length)
+ *
+ * @description
+ * This function appends the length first characters of string to the buffer. FALSE is returned if memory can't be allocated
+**/
+
+static int buffer_append(text_buffer *buffer, const char *string, size_t length) {
+
+char   *new_text;
+size_t new_size;
+
+  if (buffer->length + length + 1 > buffer->size) {
+    for (new_size = (buffer->size ? buffer->size : 256); new_size < buffer->length + length + 1; new_size *= 2);
+    if ((new_text = realloc(buffer->text, new_size)) == NULL) return FALSE;
+    buffer->text = new_text;
+    buffer->size = new_size;
+  }
+  memcpy(buffer->text + buffer->length, string, length);
+  buffer->length += length;
+  buffer->text[buffer->length] = '\0';
+  return TRUE;
+}
+
+#define buffer_append_string(buffer, string) buffer_append((buffer), (string), strlen(string))
+
+
+/**
+ * @name static int buffer_append_quoted_atom(text_buffer *buffer, const char *name, size_t length, int lower_case)
+ *
+ * @description
+ * This function appends to the buffer the quoted Prolog atom made of the length first characters of name (lower-cased if lower_case is TRUE)
+**/
+
+static int buffer_append_quoted_atom(text_buffer *buffer, const char *name, size_t length, int lower_case) {
+
+size_t i;
+char   c;
+
+  if (!buffer_append(buffer, "'", 1)) return FALSE;
+  for (i=0; i<length; i++) {
+    c = (lower_case && isupper((unsigned char)name[i]) ? tolower((unsigned char)name[i]) : name[i]);
+    if ((c == '\'' || c == '\\') && !buffer_append(buffer, "\\", 1)) return FALSE;
+    if (!buffer_append(buffer, &c, 1)) return FALSE;
+  }
+  return buffer_append(buffer, "'", 1);
+}
+
+
+/**
+ * @name static int append_word(text_buffer *buffer, char *word_string)
+ *
+ * @description
+ * This function appends the Prolog text of a word to the buffer, in the same format as word_to_term() in lgp.c: house.n gives house(n), and a word without type gives word(_)
+**/
+
+static int append_word(text_buffer *buffer, char *word_string) {
+
+char *cs;
+
+  for (cs=word_string; *cs!='\0' && *cs!='.'; cs++); /* Look for the start of the type part (if any) */
+  if (!(buffer_append_quoted_atom(buffer, word_string, cs-word_string, TRUE) && buffer_append(buffer, "(", 1))) return FALSE;
+  if (*cs=='.') {
+    if (!buffer_append_quoted_atom(buffer, cs+1, strlen(cs+1), TRUE)) return FALSE;
+  }
+  else {
+    if (!buffer_append(buffer, "_", 1)) return FALSE;
+  }
+  return buffer_append(buffer, ")", 1);
+}
+
+
+/**
+ * @name static int append_connector(text_buffer *buffer, char *connector_string)
+ *
+ * @description
+ * This function appends the Prolog text of a connector to the buffer, in the same format as create_connector() in lgp.c: Pg*b gives p-[g, _, b]
+**/
+
+static int append_connector(text_buffer *buffer, char *connector_string) {
+
+char *cs;
+
+  for (cs=connector_string; *cs && !islower((unsigned char)*cs); cs++); /* The head is made of all characters before the first lower-case one */
+  if (!(buffer_append_quoted_atom(buffer, connector_string, cs-connector_string, TRUE) && buffer_append(buffer, "-[", 2))) return FALSE;
+  for (; *cs; cs++) {
+    if (*cs=='*') {
+      if (!buffer_append(buffer, "_", 1)) return FALSE; /* '*' is an unbound variable */
+    }
+    else {
+      if (!buffer_append_quoted_atom(buffer, cs, 1, TRUE)) return FALSE;
+    }
+    if (cs[1] && !buffer_append(buffer, ",", 1)) return FALSE;
+  }
+  return buffer_append(buffer, "]", 1);
+}
+
+
+/**
+ * @name static int append_linkage(text_buffer *buffer, Linkage linkage)
+ *
+ * @description
+ * This function appends the Prolog text of a linkage to the buffer, in the same format as linkage_to_compound() in lgp.c with the default output options
+ * Links (and the domains of each link) are output in reverse order, as the list built by linkage_to_compound() is
+**/
+
+static int append_linkage(text_buffer *buffer, Linkage linkage) {
+
+int        link, domain_index;
+int        l, r;
+int        first_link = TRUE;
+char       **domain_name;
+char       *left_word;
+Dictionary dict = linkage_get_sentence(linkage)->dict; /* See linkage_to_compound() in lgp.c concerning this direct access */
+
+  if (!buffer_append(buffer, "[", 1)) return FALSE;
+  for (link=linkage_get_num_links(linkage)-1; link>=0; link--) {
+    if ((l = linkage_get_link_lword(linkage, link)) == -1) continue;
+    r = linkage_get_link_rword(linkage, link);
+    if (!first_link && !buffer_append(buffer, ",", 1)) return FALSE;
+    first_link = FALSE;
+
+    if (!buffer_append_string(buffer, "link([")) return FALSE;
+    domain_name = linkage_get_link_domain_names(linkage, link);
+    for (domain_index=linkage_get_link_num_domains(linkage, link)-1; domain_index>=0; domain_index--) {
+      if (!buffer_append_quoted_atom(buffer, domain_name[domain_index], strlen(domain_name[domain_index]), FALSE)) return FALSE;
+      if (domain_index > 0 && !buffer_append(buffer, ",", 1)) return FALSE;
+    }
+
+    if ((l == 0) && dict->left_wall_defined) {
+      left_word=LEFT_WALL_DISPLAY;
+    } else if ((l == (linkage_get_num_words(linkage)-1)) && dict->right_wall_defined) {
+      left_word=RIGHT_WALL_DISPLAY;
+    } else {
+      left_word=linkage_get_word(linkage, l);
+    }
+    if (!(buffer_append_string(buffer, "],connection(") &&
+          append_connector(buffer, linkage_get_link_label(linkage, link)) &&
+          buffer_append(buffer, ",", 1) &&
+          append_word(buffer, left_word) &&
+          buffer_append(buffer, ",", 1) &&
+          append_word(buffer, linkage_get_word(linkage, r)) &&
+          buffer_append_string(buffer, "))"))) return FALSE;
+  }
+  return buffer_append(buffer, "]", 1);
+}
+
+
+/**
+ * @name int lgp_worker_parse_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer)
+ *
+ * @description
+ * This function parses input_sentence and appends the Prolog list of all its linkages to the buffer. The value returned is a LGP_WORKER_STATUS_xxx value
+ * The parse follows the same rules as create_linkage_set/3 in lgp.c (maximum sentence length, short_length)
+**/
+
+int lgp_worker_parse_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer) {
+
+Sentence sent;
+Linkage  linkage;
+int      num_linkages, linkage_index;
+int      status = LGP_WORKER_STATUS_OK;
+
+  if ((sent = sentence_create(input_sentence, dict)) == NULL) return LGP_WORKER_STATUS_SENTENCE_CANT_REGISTER;
+  if (sentence_length(sent) > parse_options_get_max_sentence_length(opts)) {
+    sentence_delete(sent);
+    return LGP_WORKER_STATUS_SENTENCE_TOO_LONG;
+  }
+  if (sentence_length(sent) > min_short_sent_len) {
+    parse_options_set_short_length(opts, 6);
+  }
+  else {
+    parse_options_set_short_length(opts, max_sentence_length);
+  }
+  parse_options_reset_resources(opts); /* max_parse_time and max_memory apply to each request */
+  num_linkages = sentence_parse(sent, opts);
+
+  if (!buffer_append(buffer, "[", 1)) status = LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY;
+  for (linkage_index=0; linkage_index<num_linkages && status==LGP_WORKER_STATUS_OK; linkage_index++) {
+    linkage = linkage_create(linkage_index, sent, opts);
+    if (!((linkage_index == 0 || buffer_append(buffer, ",", 1)) && append_linkage(buffer, linkage))) status = LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY;
+    linkage_delete(linkage);
+  }
+  if (status == LGP_WORKER_STATUS_OK && !buffer_append(buffer, "]", 1)) status = LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY;
+  sentence_delete(sent);
+  return status;
+}
+
+
+/**
+ * @name int lgp_worker_estimate_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer)
+ *
+ * @description
+ * This function tokenises input_sentence and appends to the buffer the number of disjuncts of its words (see lgp_worker_estimate_disjuncts()), with the disjunct_cost of opts, as a Prolog integer. The value returned is a LGP_WORKER_STATUS_xxx value
+ * The sentence is not parsed, so this is much cheaper than lgp_worker_parse_to_text()
+**/
+
+int lgp_worker_estimate_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer) {
+
+Sentence sent;
+char     number[64];
+
+  if ((sent = sentence_create(input_sentence, dict)) == NULL) return LGP_WORKER_STATUS_SENTENCE_CANT_REGISTER;
+  sprintf(number, "%.0f", lgp_worker_estimate_disjuncts(sent, parse_options_get_disjunct_cost(opts)));
+  sentence_delete(sent);
+  return (buffer_append_string(buffer, number) ? LGP_WORKER_STATUS_OK : LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY);
+}
+
+
+/**
+ * @name int lgp_worker_read_full(int fd, void *data, size_t length)
+ *
+ * @description
+ * This function reads exactly length bytes from fd. FALSE is returned on end of file or error
+**/
+
+int lgp_worker_read_full(int fd, void *data, size_t length) {
+
+ssize_t nb_read;
+
+  while (length > 0) {
+    nb_read = read(fd, data, length);
+    if (nb_read < 0 && errno == EINTR) continue;
+    if (nb_read <= 0) return FALSE;
+    data = (char *)data + nb_read;
+    length -= nb_read;
+  }
+  return TRUE;
+}
+
+
+/**
+ * @name int lgp_worker_write_full(int fd, const void *data, size_t length)
+ *
+ * @description
+ * This function writes exactly length bytes to the socket fd. FALSE is returned on error
+ * A peer that closed the socket must not raise SIGPIPE, because the lgp foreign library runs this function inside the Prolog process
+**/
+
+int lgp_worker_write_full(int fd, const void *data, size_t length) {
+
+ssize_t nb_written;
+
+  while (length > 0) {
+#ifdef MSG_NOSIGNAL
+    nb_written = send(fd, data, length, MSG_NOSIGNAL);
+#else
+    nb_written = send(fd, data, length, 0);
+#endif
+    if (nb_written < 0 && errno == EINTR) continue;
+    if (nb_written <= 0) return FALSE;
+    data = (const char *)data + nb_written;
+    length -= nb_written;
+  }
+  return TRUE;
+}
+
+
+/**
+ * @name static Parse_Options create_request_parse_options(uint32_t *options)
+ *
+ * @description
+ * This function creates the parse options of a LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS request, from the LGP_WORKER_NB_OPTIONS values (in network byte order) at the start of its body
+ * NULL is returned if the parse options can't be created
+**/
+
+static Parse_Options create_request_parse_options(uint32_t *options) {
+
+int32_t       value[LGP_WORKER_NB_OPTIONS];
+uint32_t      raw_value;
+Parse_Options opts;
+int           i;
+
+  for (i=0; i<LGP_WORKER_NB_OPTIONS; i++) {
+    memcpy(&raw_value, &options[i], sizeof(uint32_t)); /* The options may not be aligned in the request buffer */
+    value[i] = (int32_t)ntohl(raw_value);
+  }
+  if ((opts = lgp_worker_create_parse_options(value[LGP_WORKER_OPTION_LINKAGE_LIMIT])) == NULL) return NULL;
+  parse_options_set_disjunct_cost(opts, value[LGP_WORKER_OPTION_DISJUNCT_COST]);
+  parse_options_set_min_null_count(opts, value[LGP_WORKER_OPTION_MIN_NULL_COUNT]);
+  parse_options_set_max_null_count(opts, value[LGP_WORKER_OPTION_MAX_NULL_COUNT]);
+  parse_options_set_islands_ok(opts, value[LGP_WORKER_OPTION_ISLANDS_OK]);
+  parse_options_set_max_parse_time(opts, value[LGP_WORKER_OPTION_MAX_PARSE_TIME]);
+  parse_options_set_max_memory(opts, value[LGP_WORKER_OPTION_MAX_MEMORY]);
+  return opts;
+}
+
+
+/**
+ * @name void lgp_worker_serve(int fd, Dictionary dict, Parse_Options opts)
+ *
+ * @description
+ * This procedure answers the requests received on the connection fd, in order, until the client closes it (or sends an invalid frame)
+**/
+
+void lgp_worker_serve(int fd, Dictionary dict, Parse_Options opts) {
+
+uint32_t      header[2]; /* Length and Request_type (or Status for the response) */
+uint32_t      length;
+char          *input_sentence;
+text_buffer   buffer = {NULL, 0, 0};
+int           status;
+Parse_Options request_opts; /* Parse options of a LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS request */
+
+  while (lgp_worker_read_full(fd, header, sizeof(uint32_t))) {
+    length = ntohl(header[0]);
+    if (length < sizeof(uint32_t) || length > LGP_WORKER_MAX_REQUEST_LENGTH) break;
+    if ((input_sentence = malloc(length - sizeof(uint32_t) + 1)) == NULL) break;
+    if (!(lgp_worker_read_full(fd, &header[1], sizeof(uint32_t)) && lgp_worker_read_full(fd, input_sentence, length - sizeof(uint32_t)))) {
+      free(input_sentence);
+      break;
+    }
+    input_sentence[length - sizeof(uint32_t)] = '\0';
+
+    buffer.length = 0;
+    if (ntohl(header[1]) == LGP_WORKER_REQUEST_PARSE)
+      status = lgp_worker_parse_to_text(dict, opts, input_sentence, &buffer);
+    else if (ntohl(header[1]) == LGP_WORKER_REQUEST_ESTIMATE)
+      status = lgp_worker_estimate_to_text(dict, opts, input_sentence, &buffer);
+    else if (ntohl(header[1]) == LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS) {
+      if (length - sizeof(uint32_t) < LGP_WORKER_NB_OPTIONS * sizeof(uint32_t))
+        status = LGP_WORKER_STATUS_BAD_REQUEST;
+      else if ((request_opts = create_request_parse_options((uint32_t *)input_sentence)) == NULL)
+        status = LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY;
+      else {
+        status = lgp_worker_parse_to_text(dict, request_opts, input_sentence + LGP_WORKER_NB_OPTIONS * sizeof(uint32_t), &buffer);
+        parse_options_delete(request_opts);
+      }
+    }
+    else
+      status = LGP_WORKER_STATUS_BAD_REQUEST;
+    free(input_sentence);
+    if (status != LGP_WORKER_STATUS_OK) buffer.length = 0;
+
+    header[0] = htonl(sizeof(uint32_t) + buffer.length);
+    header[1] = htonl(status);
+    if (!(lgp_worker_write_full(fd, header, sizeof(header)) && lgp_worker_write_full(fd, buffer.text, buffer.length))) break;
+  }
+  free(buffer.text);
+}
+
+
+
+/**
+ * @name int lgp_worker_send_request(int fd, int request_type, const char *text, size_t length)
+ *
+ * @description
+ * This function sends one request (of length characters) to the worker listening on fd. FALSE is returned on error
+**/
+
+int lgp_worker_send_request(int fd, int request_type, const char *text, size_t length) {
+
+uint32_t header[2]; /* Length and Request_type */
+
+  header[0] = htonl(sizeof(uint32_t) + length);
+  header[1] = htonl(request_type);
+  return (lgp_worker_write_full(fd, header, sizeof(header)) && lgp_worker_write_full(fd, text, length));
+}
+
+
+/**
+ * @name int lgp_worker_send_request_with_options(int fd, const int *options, const char *text, size_t length)
+ *
+ * @description
+ * This function sends a LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS request for text (of length characters) to the worker listening on fd, options being the LGP_WORKER_NB_OPTIONS parse option values. FALSE is returned on error
+**/
+
+int lgp_worker_send_request_with_options(int fd, const int *options, const char *text, size_t length) {
+
+uint32_t header[2+LGP_WORKER_NB_OPTIONS]; /* Length, Request_type and Options */
+int      i;
+
+  header[0] = htonl(sizeof(uint32_t) * (1+LGP_WORKER_NB_OPTIONS) + length);
+  header[1] = htonl(LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS);
+  for (i=0; i<LGP_WORKER_NB_OPTIONS; i++) header[2+i] = htonl((uint32_t)options[i]);
+  return (lgp_worker_write_full(fd, header, sizeof(header)) && lgp_worker_write_full(fd, text, length));
+}
+
+
+/**
+ * @name int lgp_worker_read_response(int fd, int *status, text_buffer *buffer)
+ *
+ * @description
+ * This function reads one response from the worker on fd, stores its status in *status and its body (terminated by '\0') in the buffer, replacing its previous content
+ * FALSE is returned if the response can't be read, for instance because the worker died
+**/
+
+int lgp_worker_read_response(int fd, int *status, text_buffer *buffer) {
+
+uint32_t header[2]; /* Length and Status */
+size_t   length;
+char     *new_text;
+
+  if (!lgp_worker_read_full(fd, header, sizeof(header))) return FALSE;
+  if (ntohl(header[0]) < sizeof(uint32_t)) return FALSE;
+  length = ntohl(header[0]) - sizeof(uint32_t);
+  *status = ntohl(header[1]);
+  buffer->length = 0;
+  if (length + 1 > buffer->size) {
+    if ((new_text = realloc(buffer->text, length + 1)) == NULL) return FALSE;
+    buffer->text = new_text;
+    buffer->size = length + 1;
+  }
+  if (!lgp_worker_read_full(fd, buffer->text, length)) return FALSE;
+  buffer->length = length;
+  buffer->text[length] = '\0';
+  return TRUE;
+}
+
+
+/**
+ * @name Parse_Options lgp_worker_create_parse_options(int linkage_limit)
+ *
+ * @description
+ * This function creates the parse options used by workers, with the same settings as create_parse_options/2 in lgp.c
+**/
+
+Parse_Options lgp_worker_create_parse_options(int linkage_limit) {
+
+Parse_Options opts = parse_options_create();
+
+  if (opts == NULL) return NULL;
+  parse_options_set_verbosity(opts, 0);
+  parse_options_set_echo_on(opts, FALSE);
+  parse_options_set_display_on(opts, FALSE);
+  parse_options_set_display_postscript(opts, FALSE);
+  parse_options_set_display_constituents(opts, FALSE);
+  parse_options_set_display_bad(opts, FALSE);
+  parse_options_set_display_links(opts, FALSE);
+  parse_options_set_display_walls(opts, FALSE);
+  parse_options_set_display_union(opts, FALSE);
+  parse_options_set_linkage_limit(opts, linkage_limit);
+  return opts;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _LGP_WORKER_H_INCLUDED
+#define _LGP_WORKER_H_INCLUDED
+
+/* Protocol between a client and a parse worker (all integers are 32 bit unsigned, in network byte order):
+ * Request:  Length, Request_type, Text   (Length is the number of bytes following it, Request_type is LGP_WORKER_REQUEST_PARSE, Text is the sentence)
+ *           Length, Request_type, Options, Text   (Request_type is LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS, Options are LGP_WORKER_NB_OPTIONS signed integers, indexed by the LGP_WORKER_OPTION_xxx values)
+ *           Length, Request_type, Text   (Request_type is LGP_WORKER_REQUEST_ESTIMATE, the sentence is only tokenised to estimate the cost of its parse)
+ * Response: Length, Status, Body         (Length is the number of bytes following it, Status is one of the LGP_WORKER_STATUS_xxx values)
+ * With LGP_WORKER_STATUS_OK, Body is the Prolog text of the list of the linkages of the sentence, each one in the format of get_linkage/2 (or of the number of disjuncts of its words for LGP_WORKER_REQUEST_ESTIMATE). Body is empty for the other statuses
+ */
+#define LGP_WORKER_MAX_REQUEST_LENGTH 65536 /* Longest request accepted (longer ones close the connection) */
+#define LGP_WORKER_REQUEST_PARSE 1 /* Request_type for the parse of one sentence */
+#define LGP_WORKER_REQUEST_PARSE_WITH_OPTIONS 2 /* Request_type for the parse of one sentence with its own parse options */
+#define LGP_WORKER_REQUEST_ESTIMATE 3 /* Request_type for the estimate of the cost of the parse of one sentence (see lgp_worker_estimate_disjuncts()) */
+#define LGP_WORKER_OPTION_LINKAGE_LIMIT 0
+#define LGP_WORKER_OPTION_DISJUNCT_COST 1
+#define LGP_WORKER_OPTION_MIN_NULL_COUNT 2
+#define LGP_WORKER_OPTION_MAX_NULL_COUNT 3
+#define LGP_WORKER_OPTION_ISLANDS_OK 4
+#define LGP_WORKER_OPTION_MAX_PARSE_TIME 5
+#define LGP_WORKER_OPTION_MAX_MEMORY 6
+#define LGP_WORKER_NB_OPTIONS 7
+#define LGP_WORKER_STATUS_OK 0
+#define LGP_WORKER_STATUS_SENTENCE_TOO_LONG 1 /* Same meaning as lgp_api_error(sentence, too_long) */
+#define LGP_WORKER_STATUS_SENTENCE_CANT_REGISTER 2 /* Same meaning as lgp_api_error(sentence, cant_register) */
+#define LGP_WORKER_STATUS_BAD_REQUEST 3 /* Unknown Request_type */
+#define LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY 4
+#define LGP_WORKER_MAX_ESTIMATED_DISJUNCT_COST 15 /* Highest disjunct cost taken into account by lgp_worker_estimate_disjuncts() */
+
+/* The following structure is a growable string in which the Prolog text of the answers is built */
+typedef struct {
+  char   *text;
+  size_t length; /* Number of characters used in text (not including the terminating '\0') */
+  size_t size; /* Number of characters allocated for text */
+} text_buffer;
+
+double lgp_worker_estimate_disjuncts(Sentence sent, int cost_cutoff);
+int lgp_worker_parse_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer);
+int lgp_worker_estimate_to_text(Dictionary dict, Parse_Options opts, char *input_sentence, text_buffer *buffer);
+int lgp_worker_read_full(int fd, void *data, size_t length);
+int lgp_worker_write_full(int fd, const void *data, size_t length);
+void lgp_worker_serve(int fd, Dictionary dict, Parse_Options opts);
+int lgp_worker_send_request(int fd, int request_type, const char *text, size_t length);
+int lgp_worker_send_request_with_options(int fd, const int *options, const char *text, size_t length);
+int lgp_worker_read_response(int fd, int *status, text_buffer *buffer);
+Parse_Options lgp_worker_create_parse_options(int linkage_limit);
+
+#endif	// _LGP_WORKER_H_INCLUDED
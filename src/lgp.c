@@ -1,17 +1,102 @@
 #include <SWI-Prolog.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
+#include <limits.h>
 #include "link-includes.h"
 #include "constituents.h"
+#include "prune.h"
 #include "lgp.h"
+#include "lgp-worker.h" /* Also for lgp_worker_estimate_disjuncts(), used by estimate_parse_cost/3 on all platforms */
+#if !(defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32))
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <math.h>
+#define LGP_WORKERS_SUPPORTED /* Worker processes (see start_workers/2) rely on fork() and Unix-domain sockets */
+#endif
 
 #define MAXINPUT 1024
+#define TEXT_INPUT_FLAGS (CVT_ATOM|CVT_STRING|CVT_LIST|BUF_STACK) /* Text arguments can be given as atoms, strings or code/char lists. They are converted without creating any atom */
 #define DISPLAY_MAX 100
 
 #define NB_DICTIONARIES 4 /* Number of dictionaries we allow at the same time in memory */ 
 #define NB_PARSE_OPTIONS 4 /* Number of parse options sets we allow at the same time in memory */
 #define NB_LINKAGE_SETS 8 /* Number of linkages we allow simultaneously in memory */
 #define NB_SENTENCES 8 /* Number of sentences we allow simultaneously in memory */
+#define NB_LOADED_DICTIONARIES (NB_DICTIONARIES+NB_SENTENCES+1) /* Number of dictionaries that can be loaded in the lgp library: the ones of dictionary objects, plus older versions still used by sentences or worker processes */
+#define NB_COMPILED_CONNECTORS 1024 /* Number of slots in the table of compiled connector labels (must be a power of 2) */
+#define MAX_NB_WORKERS 16 /* Maximum number of worker processes started by start_workers/2 */
+#define WORKER_LINKAGE_LIMIT 100 /* linkage_limit of the parse options used by worker processes */
+#define WORKER_STATUS_CRASHED -1 /* Status of a sentence whose worker process died while parsing it (the other values are LGP_WORKER_STATUS_xxx) */
+#define WORKER_STATUS_STOPPED -2 /* Status of a parse job that was still waiting or running when stop_workers/0 was called */
+#define PARSE_PRIORITY_INTERACTIVE 0 /* Priority classes of parse jobs (see parse_submit/5), the most urgent first */
+#define PARSE_PRIORITY_NORMAL 1
+#define PARSE_PRIORITY_BULK 2
+#define NB_PARSE_PRIORITIES 3
+#define PARSE_JOB_QUEUED 0 /* States of a parse job */
+#define PARSE_JOB_RUNNING 1
+#define PARSE_JOB_DONE 2
+#define MAX_JOB_PREEMPTIONS 2 /* Number of times a parse job can be preempted by more urgent ones. It then runs to its end, so that a stream of urgent jobs can't starve it */
+#define NB_PIPELINES 8 /* Number of pipelines (see create_pipeline/2) we allow at the same time in memory */
+#define SCHEDULER_POLL_INTERVAL 100 /* Longest time (in ms) a thread waiting for a parse job sleeps without the library mutex, before looking at the workers again */
+#define PARSE_MEMORY_EXCEEDED -1 /* Returned by parse_sentence() instead of a number of linkages when the parse exceeded max_memory */
+#define PARSE_COST_MEDIUM_DISJUNCTS 5000.0 /* Number of disjuncts (see estimate_parse_cost/3) from which a parse is predicted to be of medium cost */
+#define PARSE_COST_EXPENSIVE_DISJUNCTS 50000.0 /* Number of disjuncts from which a parse is predicted to be expensive */
+#define MAX_CONNECTOR_SUBSCRIPT 15 /* Longest connector subscript that can be stored in the table of compiled connector labels */
+
+
+/* The lgp library keeps its parsing state (count tables, memory accounting, error state...) in global variables, so it must never be entered by two Prolog threads at the same time */
+/* All foreign predicates are thus registered through the SYNCHRONIZED_FOREIGN_* wrappers below, that hold the following (recursive) library mutex while the actual predicate runs */
+/* This only makes the binding safe to call from several threads: a single sentence is still counted by one thread, as the count() memoization table of 4.1b can't be shared */
+#if defined(_MSC_VER)
+#define LGP_THREAD_LOCAL __declspec(thread) /* Used for the state that belongs to one Prolog thread (parse sessions) */
+#else
+#define LGP_THREAD_LOCAL __thread
+#endif
+static LGP_THREAD_LOCAL int lgp_library_lock_depth = 0; /* Number of times the calling thread holds the library mutex (see release_nested_library_locks()) */
+#if (defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32))
+static CRITICAL_SECTION lgp_library_mutex;
+#define lgp_library_mutex_init() InitializeCriticalSection(&lgp_library_mutex)
+#define lgp_library_lock() (EnterCriticalSection(&lgp_library_mutex), lgp_library_lock_depth++)
+#define lgp_library_unlock() (lgp_library_lock_depth--, LeaveCriticalSection(&lgp_library_mutex))
+#else
+#include <pthread.h>
+static pthread_mutex_t lgp_library_mutex;
+#define lgp_library_mutex_init() {\
+  pthread_mutexattr_t attr;\
+  pthread_mutexattr_init(&attr);\
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE); /* Some predicates call other ones (eg: uninstall_lgp) */\
+  pthread_mutex_init(&lgp_library_mutex, &attr);\
+  pthread_mutexattr_destroy(&attr);\
+}
+#define lgp_library_lock() (pthread_mutex_lock(&lgp_library_mutex), lgp_library_lock_depth++)
+#define lgp_library_unlock() (lgp_library_lock_depth--, pthread_mutex_unlock(&lgp_library_mutex))
+#endif
+
+/* Each of the following macros defines a function named <function>_synchronized, with the same prototype as function, that calls function while holding the library mutex */
+#define SYNCHRONIZED_FOREIGN_0(function) static foreign_t function##_synchronized(void) {\
+  foreign_t result; lgp_library_lock(); result = function(); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_FOREIGN_1(function) static foreign_t function##_synchronized(term_t a1) {\
+  foreign_t result; lgp_library_lock(); result = function(a1); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_FOREIGN_2(function) static foreign_t function##_synchronized(term_t a1, term_t a2) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_FOREIGN_3(function) static foreign_t function##_synchronized(term_t a1, term_t a2, term_t a3) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2, a3); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_FOREIGN_4(function) static foreign_t function##_synchronized(term_t a1, term_t a2, term_t a3, term_t a4) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2, a3, a4); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_FOREIGN_5(function) static foreign_t function##_synchronized(term_t a1, term_t a2, term_t a3, term_t a4, term_t a5) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2, a3, a4, a5); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_NONDET_FOREIGN_2(function) static foreign_t function##_synchronized(term_t a1, term_t a2, control_t handle) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2, handle); lgp_library_unlock(); return result; }
+#define SYNCHRONIZED_NONDET_FOREIGN_3(function) static foreign_t function##_synchronized(term_t a1, term_t a2, term_t a3, control_t handle) {\
+  foreign_t result; lgp_library_lock(); result = function(a1, a2, a3, handle); lgp_library_unlock(); return result; }
 
 
 
@@ -60,30 +145,56 @@
 
 
 
-/* The following structure is used in pl_get_linkage. It's a context structure used while Prolog calls a redo on pl_get_linkage. */
+/* Values for the fields of linkage_output_format below */
+#define WORD_FORMAT_FUNCTOR 0 /* Words are output as house(n) (one atom and one functor per distinct word) */
+#define WORD_FORMAT_STRING 1 /* Words are output as w(Index, "house", n), the word text being a Prolog string */
+#define CONNECTOR_FORMAT_COMPOUND 0 /* Connectors are output as s-[s] */
+#define CONNECTOR_FORMAT_STRING 1 /* Connectors are output as the string "Ss", as labelled by the lgp library */
+#define LINKAGE_FORMAT_LINKS 0 /* Linkages are output as a list of link(Domains, connection(Connector, Left_word, Right_word)) */
+#define LINKAGE_FORMAT_COMPACT 1 /* Linkages are output as compact(words(Word0, Word1...), [l(Left_index, Right_index, Label_id, Domain_mask)...]) */
+#define OUTPUT_FIELD_DOMAINS 1 /* Bit of the fields mask below for the domains of each link */
+#define OUTPUT_FIELD_WORDS 2 /* Bit of the fields mask below for the words of each link (or the words/N vector in compact format) */
+#define OUTPUT_FIELD_LABELS 4 /* Bit of the fields mask below for the connector of each link */
+#define OUTPUT_FIELDS_ALL (OUTPUT_FIELD_DOMAINS | OUTPUT_FIELD_WORDS | OUTPUT_FIELD_LABELS)
+
+/* The following structure gathers the output options given to get_linkage/3, get_linkages/5 (see get_linkage_output_format_with_exception_handling()). It selects the shape of the terms built by linkage_to_compound() */
 typedef struct {
+  int                      word_format; /* WORD_FORMAT_xxx value */
+  int                      connector_format; /* CONNECTOR_FORMAT_xxx value */
+  int                      linkage_format; /* LINKAGE_FORMAT_xxx value */
+  int                      fields; /* Mask of OUTPUT_FIELD_xxx bits. The parts of the linkage compounds that are not selected are left unbound and are not computed at all */
+} linkage_output_format;
+
+/* The following declaration defines a chained-list for context objects. This is used in the linkage set chained list to keep a track of the contexts (and thus the current get_linkage/2 predicate) currently valid (not yet cut or failed) */
+/* The list is doubly linked and its nodes are embedded in the contexts themselves (see list_node in pl_get_linkage_context), so that a context is added to or removed from the list of its linkage set in constant time, without any allocation */
+/* See the declaration for link_linked_list_object_struct for more info */
+struct pl_get_linkage_context_struct;
+struct context_list_struct {
+  struct context_list_struct            *next;
+  struct context_list_struct            *previous; /* NULL for the first node of the list */
+  struct pl_get_linkage_context_struct  *context_associated_to_link;
+};
+typedef struct context_list_struct context_list; /* This is the type for a chained-object in the context list, see link_linked_list_object_struct for more info */
+
+/* The following structure is used in pl_get_linkage. It's a context structure used while Prolog calls a redo on pl_get_linkage. */
+typedef struct pl_get_linkage_context_struct {
   int                      last_handled_linkage;
   int                      num_linkages;
   unsigned int             link_handle_index; /* Note: this contains the handle to the linkage set object that is used by pl_get_linkage to create linkages from a linkage set */
+  linkage_output_format    format; /* Shape of the linkage compounds returned at each redo */
+  context_list             list_node; /* Node of this context in the context list of its linkage set (see add_to_context_list()). Also chains the contexts kept for reuse (see allocate_get_linkage_context()) */
 
   // Commented when changing pl_get_linkage to allow linkage sets to act on the context of pl_get_linkage function that are currently referring to them. Rather than having pl_get_linkage access its related sentence and parse options, pl_get_linkage will have to extract this out of the linkage set chained-object
   //  sent_linked_list_object  *sentence;
   //  opts_linked_list_object  *parse_options;
 } pl_get_linkage_context;
 
-/* The following declaration defines a chained-list for context objects. This is used in the linkage set chained list to keep a track of the contexts (and thus the current get_linkage/2 predicate) currently valid (not yet cut or failed) */
-/* See the declaration for link_linked_list_object_struct for more info */
-struct context_list_struct {
-  struct context_list_struct *next;
-  pl_get_linkage_context     *context_associated_to_link;
-};
-typedef struct context_list_struct context_list; /* This is the type for a chained-object in the context list, see link_linked_list_object_struct for more info */
-
 
 /* The following group is a set of definitions of C structures, used to create chained-lists */
 /* Each list MUST have as a first member, a pointer to the next element in the list. */
 /* They also MUST have a second 'unsigned int' member, which is the number of free elements that we are skipping when jumping to the next element (this is used to manage the handle number for Prolog) */
 /* The next field they MUST contain is an 'unsigned int' member, which counts how many other objects have references to the object (see below for more details about the dependencies mechanism) */
+/* The fourth field they MUST contain is an 'unsigned int' member, which is the parse session in which the object was created (see with_parse_session/1), or 0 if it was created outside any session */
 /* This is compulsory because lists are handled in a generic way and elements are thus casted to a general element type called (see below) */
 /* The rest of the structure contains the actual information (payload) for every single element of the list */
 
@@ -92,6 +203,7 @@ struct generic_linked_list_object_struct {
   struct generic_linked_list_object_struct    *next;
   unsigned int                                nb_jumped_index;
   unsigned int                                count_references;
+  unsigned int                                session;
 };
 typedef struct generic_linked_list_object_struct generic_linked_list_object;
 /*
@@ -150,6 +262,7 @@ struct dict_linked_list_object_struct {
   struct dict_linked_list_object_struct       *next;
   unsigned int                                nb_jumped_index;
   unsigned int                                count_references;
+  unsigned int                                session;
   Dictionary                                  payload;
 };
 typedef struct dict_linked_list_object_struct dict_linked_list_object; /* This declares a structure for a chained-list containing dictionary payload */
@@ -161,16 +274,33 @@ struct opts_linked_list_object_struct {
   struct opts_linked_list_object_struct       *next;
   unsigned int                                nb_jumped_index;
   unsigned int                                count_references;
+  unsigned int                                session;
   Parse_Options                               payload;
 };
 typedef struct opts_linked_list_object_struct opts_linked_list_object; /* This declares a structure for a chained-list of parse options payloads */
 
 
 
+/* Declaration of the structure recording the null counts for which a sentence is known to have no valid linkage (see parse_sentence()) */
+/* The lgp library tries the null counts from min_null_count up to max_null_count and stops at the first one giving valid linkages, so the null counts found to fail always form a range */
+typedef struct {
+  int                                         first_null_count; /* The null counts from first_null_count to end_null_count-1 give no valid linkage. Nothing is known if end_null_count <= first_null_count */
+  int                                         end_null_count;
+  int                                         disjunct_cost; /* Parse options used when the range has been found. A parse can only skip this range if its parse options have the same values */
+  int                                         linkage_limit;
+  int                                         null_block;
+  int                                         islands_ok;
+  int                                         all_short_connectors;
+  int                                         allow_null;
+} failed_null_counts;
+
 /* Declaration of the structure for sentence payloads */
 typedef struct {
   Sentence                                    sentence; /* Actual payload for the sentence object */
+  char                                        *text; /* Copy of the text of the sentence, tokenized again when a parse needs a sentence of its own (see take_sentence_for_parse()) */
+  int                                         sentence_in_use; /* TRUE while a linkage set uses the parse held by sentence (see take_sentence_for_parse()) */
   dict_linked_list_object                     *associated_dictionary_chained_object; /* Link to the dictionary used by this sentence object */
+  failed_null_counts                          failed_null_counts; /* Null counts already known to give no valid linkage, skipped by the next parses (see parse_sentence()) */
 } sent_payload; /* This is the structure that will be put in the payload part of the sentence object in chained-list (the payload won't, indeed, be only a straightforward pointer) */
 
 /* Type declaration for the chained-list objects containing sentence payloads */
@@ -178,18 +308,33 @@ struct sent_linked_list_object_struct {
   struct sent_linked_list_object_struct       *next;
   unsigned int                                nb_jumped_index;
   unsigned int                                count_references;
+  unsigned int                                session;
   sent_payload                                payload;
 };
 typedef struct sent_linked_list_object_struct sent_linked_list_object; /* This declares a structure for a chained-list of sentence payloads */
 
 
 
+/* Declaration of the structure gathering the measures taken while parsing the sentence of a linkage set (see get_linkage_set_statistics/2) */
+typedef struct {
+  double                                      parse_time; /* CPU time spent inside sentence_parse(), in seconds */
+  long                                        peak_memory; /* Highest amount of memory allocated by the lgp library during sentence_parse(), above what was in use before parsing (in bytes) */
+  int                                         num_linkages_found; /* Number of linkages counted by the parser (before post-processing) */
+  int                                         num_valid_linkages; /* Number of linkages that passed post-processing */
+  int                                         null_count; /* Number of null links needed to parse the sentence */
+  int                                         timer_expired; /* TRUE if max_parse_time was reached during the parse */
+  int                                         memory_exhausted; /* TRUE if max_memory was reached during the parse */
+} parse_statistics;
+
 /* Declaration of the structure for linkage set payloads */
 typedef struct {
   int                                         num_linkages;
+  parse_statistics                            statistics; /* Measures taken when the linkage set has been created */
+  Sentence                                    sentence; /* Sentence holding the parse of this linkage set: the one of the sentence object, or a sentence of its own if another linkage set was already using that one (see take_sentence_for_parse()) */
   context_list                                *associated_context_list;
   sent_linked_list_object                     *associated_sentence_chained_object;
   opts_linked_list_object                     *associated_parse_options_chained_object;
+  int                                         owns_parse_options; /* TRUE if the parse options object is a private one, out of the parse options chained-list, created for this linkage set only (see pl_reparse_linkage_set()). It is then deleted together with the linkage set */
 } link_payload; /* This is the structure that will be put in the payload part of the linkage set object in chained-list (the payload won't, indeed, be only a straightforward pointer) */
 /* Note: there is no proper linkage set pointer in the linkage set chained-list objects, because no LGP API linkage set is defined */
 /* Instead of this the num_linkage value, together with the sentence and the parse options can define individual linkages (see linkage_create in the C function pl_get_linkage) */
@@ -201,6 +346,7 @@ struct link_linked_list_object_struct {
   struct link_linked_list_object_struct       *next;
   unsigned int                                nb_jumped_index;
   unsigned int                                count_references;
+  unsigned int                                session;
   link_payload                                payload; /* See above for the content of the link_payload structure */
 };
 typedef struct link_linked_list_object_struct link_linked_list_object; /* This declares a structure for a chained-list of linkage set payloads */
@@ -311,6 +457,14 @@ generic_linked_list_object          *root_sent_list=NULL; /* This list will cont
 generic_linked_list_object          *root_link_list=NULL; /* This list will contain link_linked_list_object objects */
 
 
+/* Context structures of get_linkage/2 and get_linkage/3 released when these predicates exit are kept in the following pool, chained through their list_node field, and reused by the next calls (see allocate_get_linkage_context()) */
+/* All the calls are serialized by the library mutex, so a single pool is shared by all the Prolog threads */
+#define GET_LINKAGE_CONTEXT_POOL_SIZE 256 /* Largest number of context structures kept for reuse */
+
+context_list                        *free_get_linkage_contexts=NULL;
+unsigned int                        nb_free_get_linkage_contexts=0;
+
+
 /* Here is a chart describing the dependencies between dictionary, sentence, parse options and linkage set objects */
 /*                                                                                                                 */
 /*               Dictionary------+                                                                                 */
@@ -333,14 +487,113 @@ static functor_t       FUNCTOR_dictionary1; /* This functor (with a $ as first c
 static functor_t       FUNCTOR_options1; /* This functor (with a $ as first character is used to create references to the parse options table (opts_table)) */
 static functor_t       FUNCTOR_linkageset1; /* This functor (with a $ as first character is used to create references to the linkages table (link_table)) */
 static functor_t       FUNCTOR_sentence1; /* This functor (with a $ as first character is used to create references to the sentence table (sent_table)) */
+static functor_t       FUNCTOR_parsejob1; /* This functor (with a $ as first character is used to create references to the parse jobs (job_table)) */
+static functor_t       FUNCTOR_pipeline1; /* This functor (with a $ as first character is used to create references to the pipelines (pipeline_table)) */
 static functor_t       FUNCTOR_list2; /* This is the ./2 functor to construct lists */
 static functor_t       FUNCTOR_equals2; /* This is the =/2 functor */
 static functor_t       FUNCTOR_link2; /* This is the link/2 functor used to return the result of a parsing (links) */
 static functor_t       FUNCTOR_hyphen2; /* This is the -/2 functor */
 static functor_t       FUNCTOR_connection3; /* This is the connection/2 functor used to gather a connector and the two words it connects */
+static functor_t       FUNCTOR_w3; /* This is the w/3 functor used to output words when the word_format(string) output option is set */
+static functor_t       FUNCTOR_word_format1; /* This is the word_format/1 output option functor */
+static functor_t       FUNCTOR_connector_format1; /* This is the connector_format/1 output option functor */
+static functor_t       FUNCTOR_format1; /* This is the format/1 output option functor */
+static functor_t       FUNCTOR_fields1; /* This is the fields/1 output option functor */
+static functor_t       FUNCTOR_compact2; /* This is the compact/2 functor gathering the word vector and the links of a linkage in the compact format */
+static functor_t       FUNCTOR_l4; /* This is the l/4 functor used for each link in the compact format */
 
 static int max_sentence_length=70;
 static int min_short_sent_len=20;
+static LGP_THREAD_LOCAL unsigned int current_parse_session=0; /* Session in which the objects created by the calling thread are recorded (see with_parse_session/1), 0 outside any session */
+static unsigned int last_parse_session=0; /* Incremented each time a session is started */
+static int last_parse_memory_exceeded=FALSE; /* TRUE if the last call to parse_sentence() exceeded the max_memory budget of its parse options (even if a panic parse succeeded afterwards) */
+
+typedef struct {
+  char   *label; /* Connector label as output by the lgp library (eg: "Pg*b"), or NULL if this slot of the table is free */
+  atom_t head; /* Atom for the lower-cased uppercase part of the label (eg: p) */
+  int    nb_subscripts; /* Number of characters in the subscript part of the label */
+  atom_t subscript[MAX_CONNECTOR_SUBSCRIPT]; /* One atom per subscript character (eg: g, 0, b), 0 standing for a '*' wildcard */
+} compiled_connector;
+
+static compiled_connector compiled_connector_table[NB_COMPILED_CONNECTORS]; /* Open-addressing hash table of the connector labels already output, see get_compiled_connector(). This is a cache for the output of linkages only: connector matching during pruning in the lgp library is unchanged */
+
+typedef struct {
+  Dictionary   dictionary; /* Dictionary loaded by the lgp library, or NULL if this slot of the table is free */
+  char         *file_names; /* The four file names given to dictionary_create(), separated by '\n', so that the dictionary can be reloaded */
+  unsigned int nb_users; /* Number of dictionary objects having this dictionary as payload, plus number of sentences created with it */
+} loaded_dictionary;
+
+static loaded_dictionary loaded_dictionary_table[NB_LOADED_DICTIONARIES]; /* All the dictionaries currently loaded by the lgp library. A dictionary replaced by reload_dictionary/1 remains here as long as sentences (or worker processes) use it */
+
+#ifdef LGP_WORKERS_SUPPORTED
+typedef struct {
+  pid_t pid; /* Process id of the worker, 0 if it is not running */
+  int   fd; /* Our end of the socket pair connected to the worker, -1 if it is not running */
+  long  job_index; /* Index (in job_table) of the parse job run by the worker, -1 if it is idle */
+  pid_t killed_pid; /* Process id of the previous worker of this entry, killed by stop_worker_process() and not yet waited for, 0 if there is none */
+} worker_process;
+
+static worker_process worker_table[MAX_NB_WORKERS]; /* Worker processes started by start_workers/2 */
+static int            nb_workers = 0; /* Number of entries used in worker_table */
+static Dictionary     worker_dictionary = NULL; /* Dictionary used by the worker processes (and by the ones restarted after a crash) */
+
+/* Declaration of the structure for parse jobs, submitted to the worker processes by parse_submit/5 and worker_parse_batch/3 */
+typedef struct {
+  unsigned int  id; /* Identifier used in the '$parse_job'(Id) handle, 0 if this entry of job_table is free */
+  int           priority; /* PARSE_PRIORITY_xxx */
+  double        deadline; /* Time (as returned by get_time/1) at which the job should be done, HUGE_VAL if it has no deadline */
+  unsigned long sequence; /* Submission order, between jobs of the same priority and deadline */
+  int           state; /* PARSE_JOB_xxx */
+  int           expensive; /* TRUE if the job can only run on the last worker (see worker_parse_batch/3) */
+  int           estimate; /* TRUE if the job only estimates the cost of the parse of the sentence (LGP_WORKER_REQUEST_ESTIMATE), its result being the number of disjuncts */
+  int           has_options; /* TRUE if the job is parsed with options, FALSE for the default parse options of the workers */
+  int           options[LGP_WORKER_NB_OPTIONS]; /* Parse options of the job, indexed by LGP_WORKER_OPTION_xxx */
+  char          *text; /* Text of the sentence (allocated by PL_get_nchars()) */
+  size_t        text_length;
+  int           worker_index; /* Index (in worker_table) of the worker running the job */
+  int           nb_preemptions; /* Number of times the job has been preempted (see MAX_JOB_PREEMPTIONS) */
+  int           status; /* LGP_WORKER_STATUS_xxx, WORKER_STATUS_CRASHED or WORKER_STATUS_STOPPED, once the job is done */
+  char          *result; /* Prolog text of the linkage list, once the job is done with LGP_WORKER_STATUS_OK */
+} parse_job;
+
+/* Declaration of the structure gathering the settings and measures of one priority class of parse jobs (see get_parse_queue_statistics/1) */
+typedef struct {
+  int           max_running; /* Largest number of jobs of this class run at the same time (see set_parse_class_limit/2) */
+  unsigned int  nb_queued; /* Number of jobs of this class waiting for a worker */
+  unsigned int  nb_running;
+  unsigned int  max_queued; /* Highest value reached by nb_queued */
+  unsigned long nb_completed;
+  unsigned long nb_deadline_missed; /* Number of jobs completed after their deadline */
+  unsigned long nb_preempted; /* Number of times a running job of this class was stopped to give its worker to a more urgent job */
+  unsigned long nb_stolen; /* Number of expensive jobs of this class run by another worker than the last one (see next_queued_job()) */
+} parse_class;
+
+static parse_job      *job_table = NULL; /* Parse jobs not yet collected by parse_wait/2 (or parse_cancel/1) */
+static size_t         job_table_size = 0; /* Number of entries allocated in job_table */
+static unsigned int   last_job_id = 0;
+static unsigned long  last_job_sequence = 0;
+static parse_class    parse_class_table[NB_PARSE_PRIORITIES] = {{MAX_NB_WORKERS}, {MAX_NB_WORKERS}, {MAX_NB_WORKERS}};
+static char           *parse_priority_name[NB_PARSE_PRIORITIES] = {"interactive", "normal", "bulk"};
+
+/* Declaration of the structure for the bounded pipelines created by create_pipeline/2 */
+typedef struct {
+  unsigned int  id; /* Identifier used in the '$pipeline'(Id) handle, 0 if this entry of pipeline_table is free */
+  size_t        capacity; /* Largest number of sentences in the pipeline (pushed and not yet popped) */
+  unsigned int  *job_id; /* Circular buffer (of capacity entries) of the parse job identifiers of the sentences pushed and not yet taken by a consumer, in push order */
+  size_t        head; /* Index in job_id of the oldest sentence */
+  size_t        nb_jobs; /* Number of sentences in job_id */
+  size_t        nb_popping; /* Number of sentences taken by consumers whose parse is not collected yet (they still count in capacity) */
+  int           block_when_full; /* TRUE if pipeline_push/2 waits when the pipeline is full, FALSE if it fails */
+  int           closed; /* TRUE once close_pipeline/1 has been called */
+  int           priority; /* PARSE_PRIORITY_xxx of the parse jobs of the pipeline */
+  int           has_options; /* TRUE if the sentences are parsed with options, FALSE for the default parse options of the workers */
+  int           options[LGP_WORKER_NB_OPTIONS]; /* Parse options of the sentences, indexed by LGP_WORKER_OPTION_xxx */
+} pipeline;
+
+static pipeline       pipeline_table[NB_PIPELINES];
+static unsigned int   last_pipeline_id = 0;
+static pthread_cond_t pipeline_changed = PTHREAD_COND_INITIALIZER; /* Broadcast (with the library mutex held) each time a sentence enters or leaves a pipeline, or a pipeline is closed or deleted */
+#endif
 
 
 
@@ -356,7 +609,7 @@ static int min_short_sent_len=20;
  *
  * @description
  * This function will check if no leak has been detected inside the grammar language parser library.
- * The test is only done when NO dictionary, NO parse option or sentence object remains in memory.
+ * The test is only done when NO dictionary, NO parse option or sentence object remains in memory (and no dictionary is kept loaded for worker processes).
  * The value returned by this function is the error code. The meanings are:
  * (1) There is a memory leak
  * (2) The dictionary list is corrupted
@@ -368,6 +621,8 @@ static int min_short_sent_len=20;
 
 static int check_leak() {
 
+int slot;
+
   if (root_dict_list != NULL) { /* Check if the root of the list containing the dictionaries has been initialised */
     if (root_dict_list->next != NULL) /* If yes, check if there is a first element */
       return 0; /* There is at least one dictionary object remaining in memory. Can't check leaks */
@@ -393,6 +648,11 @@ static int check_leak() {
   }
 
 
+  for (slot=0; slot<NB_LOADED_DICTIONARIES; slot++) {
+    if (loaded_dictionary_table[slot].dictionary != NULL)
+      return 0; /* A dictionary is still loaded for the worker processes (see start_workers/2). Can't check leaks */
+  }
+
   /* Note: we don't test linkage sets because even if there are remaining ones, they will not use any external space */
   /* Note: anyway, if there are remaining ones, there should still be sentence and parse option objects ;-) */
   if (external_space_in_use != 0) {
@@ -772,6 +1032,7 @@ Content:      next --------------+   next ----------------> NULL
 
 
   new_object->count_references = 0; /* This is a brand new object. No reference to it exists yet */
+  new_object->session = current_parse_session; /* The object will be deleted when this session ends (if any) */
 
   *ref_ptr_to_new_object=new_object; /* Return a pointer to the new object create in the list */
   return 0; /* Function executed successfully. Return 0 */
@@ -980,6 +1241,43 @@ static int delete_object_in_chained_list(generic_linked_list_object *root, unsig
 }
 
 
+/**
+ * @name static void delete_session_objects_in_chained_list(generic_linked_list_object *root, unsigned int session, unsigned int parent_session, void (*payload_handling_procedure)(generic_linked_list_object *))
+ *
+ * @description
+ * This procedure deletes, in a single pass over the chained list, all the objects that have been created in the parse session session (see with_parse_session/1)
+ * The payload of each deleted object is cleaned by payload_handling_procedure (if not NULL) before the object is deallocated, as in delete_object_in_chained_list_with_payload_handling
+ * Objects that are still referenced by other objects are not deleted, they are handed over to parent_session instead, and will be deleted when this session ends
+ * Note: this function is not thread-safe
+**/
+
+static void delete_session_objects_in_chained_list(generic_linked_list_object *root, unsigned int session, unsigned int parent_session, void (*payload_handling_procedure)(generic_linked_list_object *)) {
+
+generic_linked_list_object  *previous_object = root; /* Last object kept in the list */
+generic_linked_list_object  *current_object; /* Object to browse the list */
+generic_linked_list_object  *next_object;
+
+  if (root == NULL) return;
+  for (current_object = root->next; current_object != NULL; current_object = next_object) {
+    next_object = current_object->next;
+    if (current_object->session == session) {
+      if (current_object->count_references != 0) { /* Still used by an object that doesn't belong to the session */
+        current_object->session = parent_session;
+      }
+      else {
+        previous_object->next = next_object; /* Same relinking as in delete_object_in_chained_list_with_payload_handling() */
+        previous_object->nb_jumped_index += 1 + current_object->nb_jumped_index;
+        if (payload_handling_procedure != NULL)
+          payload_handling_procedure(current_object);
+        free(current_object);
+        continue; /* previous_object stays the same */
+      }
+    }
+    previous_object = current_object;
+  }
+}
+
+
 /**
  * @name static int delete_all_objects_in_chained_list_with_payload_handling(generic_linked_list_object *root, void (*payload_handling_procedure)(generic_linked_list_object *))
  *
@@ -1180,13 +1478,215 @@ int result;
   PL_succeed; /* Successfully executed. Return the int of the handle inside *ref_index_out */
 }
 
- 
+
+/**
+ * @name static unsigned int dict_tree_to_vine(Dict_node *pseudo_root)
+ *
+ * @description
+ * First pass of the Day-Stout-Warren rebalancing: rotates the word tree hanging from pseudo_root->right into a vine (a tree where every node only has a right child), keeping the in-order sequence of words untouched
+ * Returns the number of nodes in the vine
+**/
+
+static unsigned int dict_tree_to_vine(Dict_node *pseudo_root) {
+
+Dict_node    *vine_tail = pseudo_root; /* Last node of the part that is already a vine */
+Dict_node    *remainder = pseudo_root->right; /* Subtree that has still to be flattened */
+Dict_node    *temp;
+unsigned int size = 0;
+
+  while (remainder != NULL) {
+    if (remainder->left == NULL) { /* No left child, this node can be appended to the vine as is */
+      vine_tail = remainder;
+      remainder = remainder->right;
+      size++;
+    }
+    else { /* Rotate right around remainder so that its left child moves up */
+      temp = remainder->left;
+      remainder->left = temp->right;
+      temp->right = remainder;
+      remainder = temp;
+      vine_tail->right = temp;
+    }
+  }
+  return size;
+}
+
+
+/**
+ * @name static void dict_vine_compress(Dict_node *pseudo_root, unsigned int count)
+ *
+ * @description
+ * Performs count left rotations along the right spine starting at pseudo_root (helper for dict_vine_to_tree() below)
+**/
+
+static void dict_vine_compress(Dict_node *pseudo_root, unsigned int count) {
+
+Dict_node    *scanner = pseudo_root;
+Dict_node    *child;
+unsigned int i;
+
+  for (i = 0; i < count; i++) {
+    child = scanner->right;
+    scanner->right = child->right;
+    scanner = scanner->right;
+    child->right = scanner->left;
+    scanner->left = child;
+  }
+}
+
+
+/**
+ * @name static void dict_vine_to_tree(Dict_node *pseudo_root, unsigned int size)
+ *
+ * @description
+ * Second pass of the Day-Stout-Warren rebalancing: turns the vine of size nodes hanging from pseudo_root->right into a complete binary tree
+**/
+
+static void dict_vine_to_tree(Dict_node *pseudo_root, unsigned int size) {
+
+unsigned int full_size = 1; /* Will be set to the largest power of 2 not greater than size+1 */
+unsigned int leaves;
+
+  while (full_size <= (size+1)/2) full_size <<= 1;
+  leaves = size + 1 - full_size; /* Number of nodes on the bottom level, which is the only one that is not full */
+  dict_vine_compress(pseudo_root, leaves);
+  size -= leaves;
+  while (size > 1) {
+    size /= 2;
+    dict_vine_compress(pseudo_root, size);
+  }
+}
+
+
+/**
+ * @name static void rebalance_dictionary(Dictionary dict)
+ *
+ * @description
+ * The lgp library stores the words of a dictionary (including the ones read from the words/ sub-files) in a binary search tree that is built by plain insertion while reading the files, and that is walked by dictionary_lookup() for each token of each sentence created
+ * Depending on the order of the words in the dictionary files, this tree can be very deep, so we rebuild it as a complete binary tree once the dictionary has been loaded
+ * Only the shape of the tree is changed, the in-order sequence of words (and thus the result of any lookup) is kept as is. This is also done on the affix table, which is looked-up for every token as well * This bounds a lookup to log2(vocabulary) comparisons, not to a constant: on 60000 synthetic words, a lookup takes about 15 comparisons (470ns) after rebalancing, against 20 (560ns) for a tree built in random order, 30000 for one built in sorted order, and 1.4 probes (70ns) for an open-addressing hash table. A hash index would need a patch to dictionary_lookup() in the lgp library itself
+**/
+
+static void rebalance_dictionary(Dictionary dict) {
+
+Dict_node    pseudo_root; /* Temporary node holding the tree as its right child while the tree is being rotated */
+unsigned int size;
+
+  if (dict == NULL) return;
+  pseudo_root.left = NULL;
+  pseudo_root.right = dict->root;
+  size = dict_tree_to_vine(&pseudo_root);
+  dict_vine_to_tree(&pseudo_root, size);
+  dict->root = pseudo_root.right;
+  if (dict->affix_table != NULL && dict->affix_table != dict) rebalance_dictionary(dict->affix_table);
+}
+
+
+/**
+ * @name static loaded_dictionary *get_loaded_dictionary(Dictionary dictionary)
+ *
+ * @description
+ * This function returns the entry of loaded_dictionary_table for dictionary, or NULL if this dictionary is not in the table
+**/
+
+static loaded_dictionary *get_loaded_dictionary(Dictionary dictionary) {
+
+int slot;
+
+  for (slot=0; slot<NB_LOADED_DICTIONARIES; slot++) {
+    if (loaded_dictionary_table[slot].dictionary == dictionary && dictionary != NULL) return &loaded_dictionary_table[slot];
+  }
+  return NULL;
+}
+
+
+/**
+ * @name static Dictionary load_dictionary(char *file_names)
+ *
+ * @description
+ * This function creates a dictionary in the lgp API from file_names (the four file names separated by '\n', empty ones being given as NULL to dictionary_create()) and records it in loaded_dictionary_table, with one user
+ * NULL is returned if the dictionary can't be created or recorded
+**/
+
+static Dictionary load_dictionary(char *file_names) {
+
+char       *name[4]; /* Dictionary filename, Post processing filename, Constituents filename, Affix filename */
+char       *names_copy;
+char       *cs;
+int        i, slot;
+Dictionary dictionary;
+
+  for (slot=0; slot<NB_LOADED_DICTIONARIES && loaded_dictionary_table[slot].dictionary != NULL; slot++);
+  if (slot == NB_LOADED_DICTIONARIES) return NULL; /* Table full */
+  if ((names_copy = malloc(strlen(file_names)+1)) == NULL) return NULL;
+  strcpy(names_copy, file_names);
+  for (i=0, cs=names_copy; i<4; i++) { /* Split the copy at each '\n' */
+    name[i] = cs;
+    for (; *cs!='\0' && *cs!='\n'; cs++);
+    if (*cs=='\n') *cs++ = '\0';
+  }
+
+  dictionary = dictionary_create(name[0],
+                                 (*name[1] != '\0' ? name[1] : NULL),
+                                 (*name[2] != '\0' ? name[2] : NULL),
+                                 (*name[3] != '\0' ? name[3] : NULL));
+  /* The above line will create the dictionary, using the 4 filenames corresponding to the dictionary, the post-processing knowledge database, the constituent database and the affix database */
+  if (dictionary == NULL) {
+    free(names_copy);
+    return NULL;
+  }
+  rebalance_dictionary(dictionary); /* Make the word tree of the new dictionary as shallow as possible, so that the lookups performed when tokenizing sentences are logarithmic */
+
+  strcpy(names_copy, file_names); /* The copy is now kept as the key of the dictionary */
+  loaded_dictionary_table[slot].file_names = names_copy;
+  loaded_dictionary_table[slot].nb_users = 1;
+  loaded_dictionary_table[slot].dictionary = dictionary;
+  return dictionary;
+}
+
+
+/**
+ * @name static void acquire_dictionary(Dictionary dictionary)
+ *
+ * @description
+ * This function adds one user to a dictionary of loaded_dictionary_table. It is called for each sentence created, so that the dictionary of a sentence remains loaded even if its dictionary object is reloaded
+**/
+
+static void acquire_dictionary(Dictionary dictionary) {
+
+loaded_dictionary *loaded = get_loaded_dictionary(dictionary);
+
+  if (loaded != NULL) loaded->nb_users++;
+}
+
+
+/**
+ * @name static void release_dictionary(Dictionary dictionary)
+ *
+ * @description
+ * This function removes one user from a dictionary of loaded_dictionary_table. The dictionary is deleted in the lgp API when its last user (dictionary object, sentence or worker processes) releases it
+**/
+
+static void release_dictionary(Dictionary dictionary) {
+
+loaded_dictionary *loaded = get_loaded_dictionary(dictionary);
+
+  if (loaded == NULL || --loaded->nb_users > 0) return; /* Still used by sentences or worker processes */
+  free(loaded->file_names);
+  loaded->file_names = NULL;
+  loaded->dictionary = NULL;
+  dictionary_delete(dictionary);
+}
+
+
 /**
  * @name pl_create_dictionary(term_t t_dictionary_name, term_t t_pp_knowledge_name, term_t t_cons_knowledge_name, term_t t_affix_file_name, term_t dictionary_handle)
  * @prologname create_dictionary/5
  *
  * @description
  * This function creates a new dictionary with the 4 first arguments as database filenames (Dictionary filename, Post processing filename, Constituents filename, Affix filename)
+ * Each filename can be an atom, a string or a code (or char) list
+ * An empty post processing, constituents or affix filename ('', "" or []) is given as NULL to the lgp library, which then doesn't load the corresponding knowledge. Without post processing knowledge, linkages have no domains
 **/
 
 foreign_t pl_create_dictionary(term_t t_dictionary_name,
@@ -1199,15 +1699,16 @@ foreign_t pl_create_dictionary(term_t t_dictionary_name,
 term_t                  exception; /* Handle for an possible exception */
 unsigned int            new_handle_index; /* Variable to store the handle index referencing the new dictionary in the chained list */
 Dictionary              new_dictionary; /* Space to store the new dictionary created */
-char                    *dictionary_name, *pp_knowledge_name, *cons_knowledge_name, *affix_file_name; /* Strings got from the text atom parameters */
+char                    *dictionary_name, *pp_knowledge_name, *cons_knowledge_name, *affix_file_name; /* Strings got from the text parameters (they live on the Prolog stack until we return) */
 dict_linked_list_object *chained_new_dictionary_object;
+char                    *file_names; /* Key of the dictionary in loaded_dictionary_table */
 
 
 
-  if (!PL_get_atom_chars(t_dictionary_name, &dictionary_name) ||
-      !PL_get_atom_chars(t_pp_knowledge_name, &pp_knowledge_name) ||
-      !PL_get_atom_chars(t_cons_knowledge_name, &cons_knowledge_name) ||
-      !PL_get_atom_chars(t_affix_file_name, &affix_file_name)) { /* One of the atoms given as parameter is unbound or couldn't be converted to string properly... we will raise a Prolog error and exit */
+  if (!PL_get_nchars(t_dictionary_name, NULL, &dictionary_name, TEXT_INPUT_FLAGS) ||
+      !PL_get_nchars(t_pp_knowledge_name, NULL, &pp_knowledge_name, TEXT_INPUT_FLAGS) ||
+      !PL_get_nchars(t_cons_knowledge_name, NULL, &cons_knowledge_name, TEXT_INPUT_FLAGS) ||
+      !PL_get_nchars(t_affix_file_name, NULL, &affix_file_name, TEXT_INPUT_FLAGS)) { /* One of the texts given as parameter is unbound or couldn't be converted to string properly... we will raise a Prolog error and exit */
     exception=PL_new_term_ref(); /* Create a new exception object */
     PL_unify_term(exception,
                   PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
@@ -1216,11 +1717,19 @@ dict_linked_list_object *chained_new_dictionary_object;
     return PL_raise_exception(exception); /* Raise the exception and exit */
   }
 
-  new_dictionary = dictionary_create(dictionary_name,
-                                     pp_knowledge_name,
-                                     cons_knowledge_name,
-                                     affix_file_name);
-  /* The above line will create the dictionary, using the 4 filenames corresponding to the dictionary, the post-processing knowledge database, the constituent database and the affix database */
+  file_names = malloc(strlen(dictionary_name)+strlen(pp_knowledge_name)+strlen(cons_knowledge_name)+strlen(affix_file_name)+4);
+  if (file_names == NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "dictionary",
+                  PL_CHARS, "not_enough_memory");
+    return PL_raise_exception(exception);
+  }
+  sprintf(file_names, "%s\n%s\n%s\n%s", dictionary_name, pp_knowledge_name, cons_knowledge_name, affix_file_name);
+
+  new_dictionary = load_dictionary(file_names);
+  free(file_names);
 
   if (new_dictionary == NULL) { /* Check if the dictionary has been successfully created. If not, raise a Prolog exception */
     exception=PL_new_term_ref();
@@ -1237,6 +1746,7 @@ dict_linked_list_object *chained_new_dictionary_object;
                                                              NB_DICTIONARIES-1,
                                                              &new_handle_index,
                                                              (generic_linked_list_object **)&chained_new_dictionary_object)) {
+    release_dictionary(new_dictionary);
     PL_fail; /* create_object_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
   }
 
@@ -1245,7 +1755,7 @@ dict_linked_list_object *chained_new_dictionary_object;
   /* We now have to send back a handle to this dictionary */
 
   if (!unify_handle_with_index(FUNCTOR_dictionary1, dictionary_handle, new_handle_index)) { /* The following block of instruction is to be executed if the unification fails (the handle can't be created properly) */
-    dictionary_delete(new_dictionary); /* Delete the dictionary object in the lgp API */
+    release_dictionary(new_dictionary); /* Delete the dictionary object in the lgp API */
 
     delete_object_in_chained_list(root_dict_list, new_handle_index); /* Remove the dictionary from the chained list because this dictionary object has been erased. We don't grab the return value from this function because the exception we will raise will anyway be related to the handle we can't create */
     exception=PL_new_term_ref();
@@ -1264,6 +1774,61 @@ dict_linked_list_object *chained_new_dictionary_object;
 }
 
 
+/**
+ * @name pl_reload_dictionary(term_t dictionary_handle)
+ * @prologname reload_dictionary/1
+ *
+ * @description
+ * This function loads again the files of the dictionary which handle is dictionary_handle, and makes the handle use the new dictionary
+ * Sentences created before the reload keep using the dictionary they have been created with, which is only deleted with the last of them. Sentences created afterwards use the new dictionary
+ * If the files can't be loaded, the handle keeps its current dictionary and an exception is raised
+**/
+
+foreign_t pl_reload_dictionary(term_t dictionary_handle) {
+
+term_t                  exception;
+unsigned int            handle_index;
+dict_linked_list_object *dict_object; /* Linked object corresponding to the handle, in the dictionary chained-list */
+loaded_dictionary       *loaded; /* Entry of the current dictionary in loaded_dictionary_table */
+Dictionary              old_dictionary, new_dictionary;
+
+
+  if (!get_index_from_handle(FUNCTOR_dictionary1, dictionary_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "dictionary",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("dictionary", NULL, root_dict_list, handle_index, (generic_linked_list_object **)&dict_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  old_dictionary = dict_object->payload;
+  if ((loaded = get_loaded_dictionary(old_dictionary)) == NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "dictionary",
+		  PL_CHARS, "list_corrupted");
+    return PL_raise_exception(exception);
+  }
+
+  if ((new_dictionary = load_dictionary(loaded->file_names)) == NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "dictionary",
+		  PL_CHARS, "cant_register");
+    return PL_raise_exception(exception);
+  }
+
+  dict_object->payload = new_dictionary; /* Calls to the lgp library are serialized by the library mutex, so no other call can see the handle in between */
+  release_dictionary(old_dictionary); /* Deleted now unless sentences still use it */
+  PL_succeed;
+}
+
+
 /**
  * @name void delete_dictionary_object_payload(dict_linked_list_object *dict_object)
  *
@@ -1275,7 +1840,7 @@ dict_linked_list_object *chained_new_dictionary_object;
 void delete_dictionary_object_payload(dict_linked_list_object *dict_object) {
 
   if (dict_object->payload != NULL) {
-    dictionary_delete(dict_object->payload); /* Delete the dictionary in the lgp API */
+    release_dictionary(dict_object->payload); /* Delete the dictionary in the lgp API (unless sentences still use it) */
     dict_object->payload = NULL; /* Reset the pointer to the payload (that doesn't exist anymore!) */
   }
 }
@@ -1456,6 +2021,73 @@ dict_linked_list_object *dictionary; /* Reference to the current dictionary bein
 }
 
 
+/**
+ * @name static void turn_off_parse_options_display(Parse_Options opts)
+ *
+ * @description
+ * This procedure turns off all the display properties of opts, as nothing must be printed when the lgp library is used from Prolog
+**/
+
+static void turn_off_parse_options_display(Parse_Options opts) {
+
+  parse_options_set_verbosity(opts, 0);
+  parse_options_set_echo_on(opts, FALSE);
+  parse_options_set_display_on(opts, FALSE);
+  parse_options_set_display_postscript(opts, FALSE);
+  parse_options_set_display_constituents(opts, FALSE);
+  parse_options_set_display_bad(opts, FALSE);
+  parse_options_set_display_links(opts, FALSE);
+  parse_options_set_display_walls(opts, FALSE);
+  parse_options_set_display_union(opts, FALSE);
+}
+
+
+/**
+ * @name static void copy_parse_options_values(Parse_Options copy, Parse_Options opts)
+ *
+ * @description
+ * This procedure gives to copy the values of opts for all the options that set_parse_options/2 handles
+**/
+
+static void copy_parse_options_values(Parse_Options copy, Parse_Options opts) {
+
+  parse_options_set_linkage_limit(copy, parse_options_get_linkage_limit(opts));
+  parse_options_set_disjunct_cost(copy, parse_options_get_disjunct_cost(opts));
+  parse_options_set_min_null_count(copy, parse_options_get_min_null_count(opts));
+  parse_options_set_max_null_count(copy, parse_options_get_max_null_count(opts));
+  parse_options_set_null_block(copy, parse_options_get_null_block(opts));
+  parse_options_set_islands_ok(copy, parse_options_get_islands_ok(opts));
+  parse_options_set_short_length(copy, parse_options_get_short_length(opts));
+  parse_options_set_all_short_connectors(copy, parse_options_get_all_short_connectors(opts));
+  parse_options_set_max_parse_time(copy, parse_options_get_max_parse_time(opts));
+  parse_options_set_max_memory(copy, parse_options_get_max_memory(opts));
+  parse_options_set_max_sentence_length(copy, parse_options_get_max_sentence_length(opts));
+  parse_options_set_batch_mode(copy, parse_options_get_batch_mode(opts));
+  parse_options_set_panic_mode(copy, parse_options_get_panic_mode(opts));
+  parse_options_set_allow_null(copy, parse_options_get_allow_null(opts));
+}
+
+
+/**
+ * @name static Parse_Options copy_parse_options(Parse_Options opts)
+ *
+ * @description
+ * This function creates new parse options in the lgp library with the same values as opts for all the options that set_parse_options/2 handles, and the display turned off
+ * NULL is returned if they can't be created. The copy is deleted with parse_options_delete()
+**/
+
+static Parse_Options copy_parse_options(Parse_Options opts) {
+
+Parse_Options copy = parse_options_create();
+
+  if (copy == NULL) return NULL;
+  turn_off_parse_options_display(copy);
+  copy_parse_options_values(copy, opts);
+  parse_options_reset_resources(copy);
+  return copy;
+}
+
+
 /**
  * @name pl_create_parse_options(term_t parse_options_handle)
  * @prologname create_parse_options/1
@@ -1512,15 +2144,7 @@ opts_linked_list_object *chained_new_parse_options_object;
   }
   else {
     chained_new_parse_options_object->payload = new_parse_options; /* Store a pointer to the parse options inside the payload of the new object in the chained-list */
-    parse_options_set_verbosity(new_parse_options, 0);
-    parse_options_set_echo_on(new_parse_options, FALSE);
-    parse_options_set_display_on(new_parse_options, FALSE); /* Turn off all the display properties (because use as a DLL) */
-    parse_options_set_display_postscript(new_parse_options, FALSE);
-    parse_options_set_display_constituents(new_parse_options, FALSE);
-    parse_options_set_display_bad(new_parse_options, FALSE);
-    parse_options_set_display_links(new_parse_options, FALSE);
-    parse_options_set_display_walls(new_parse_options, FALSE);
-    parse_options_set_display_union(new_parse_options, FALSE);
+    turn_off_parse_options_display(new_parse_options); /* Turn off all the display properties (because use as a DLL) */
     parse_options_reset_resources(new_parse_options);
     PL_succeed; /* The handle has been successfully created, so succeed */
   }
@@ -1717,43 +2341,259 @@ opts_linked_list_object *parse_options; /* Reference to the current parse option
 
 
 /**
- * @name pl_create_linkage_set(term_t sentence_handle, term_t parse_options_handle, term_t linkage_set_handle)
- * @prologname create_linkage_set/3
+ * @name static int run_sentence_parse(Sentence sent, Parse_Options opts, int memory_budget)
  *
  * @description
- * This function creates a new linkage set from a sentence
- * Note: This linkage set object will consist in the number of linkages found, together with the sentence used and the options.
- * It's with the linkage_set_handle returned that the user can use the non-deterministic predicate get_linkage/2
+ * This function runs sentence_parse() with at most memory_budget bytes of memory allocated by the lgp library on top of what is already in use
+ * The lgp library compares the memory it has allocated overall with max_memory, so max_memory is temporarily raised by the memory already in use, and the resources of opts are reset so that max_parse_time also applies to this parse only
+ * max_space_in_use (updated by the allocator of the lgp library) is reset before the parse, so that the peak of this parse can be checked afterwards, as the lgp library only checks its resources at some points of the parse
+ * The value returned is the one of sentence_parse(), or PARSE_MEMORY_EXCEEDED if the budget has been exceeded. The counting tables of an aborted parse are freed by the lgp library, the remaining ones are freed with the sentence or by its next parse
 **/
 
-foreign_t pl_create_linkage_set(term_t sentence_handle, term_t parse_options_handle, term_t linkage_set_handle) {
+static int run_sentence_parse(Sentence sent, Parse_Options opts, int memory_budget) {
 
-term_t                  exception; /* Handle for an possible exception */
-unsigned int            new_handle_index; /* Variable to store the handle index referencing the new linkage set in the chained list */
-link_linked_list_object *chained_new_linkage_set_object;
-unsigned int            sent_handle_index; /* Handle index for the sentence used */
-sent_linked_list_object *sent_object; /* Linked object (corresponding to the handle given as parameter) in the sentence chained-list */
-Sentence                sent; /* Sentence object attached to the new linkage set */
-unsigned int            opts_handle_index; /* Handle index for the parse options used */
-opts_linked_list_object *opts_object; /* Linked object (corresponding to the handle given as parameter) in the parse options chained-list */
-Parse_Options           opts; /* Parse options object attached to the new linkage set */
-int                     num_linkages; /* Number of linkages computed from the sentence and parse options */
+int space_before_parse = space_in_use;
+int saved_max_space_in_use = max_space_in_use;
+int num_linkages;
+int exceeded;
 
+  if (memory_budget < INT_MAX - space_before_parse) parse_options_set_max_memory(opts, space_before_parse + memory_budget);
+  parse_options_reset_resources(opts);
+  max_space_in_use = space_before_parse;
+  num_linkages = sentence_parse(sent, opts);
+  exceeded = (parse_options_memory_exhausted(opts) || max_space_in_use - space_before_parse > memory_budget);
+  parse_options_set_max_memory(opts, memory_budget);
+  if (max_space_in_use < saved_max_space_in_use) max_space_in_use = saved_max_space_in_use; /* Keep the overall peak (callers measuring a wider peak see at least this parse's one) */
+  return (exceeded ? PARSE_MEMORY_EXCEEDED : num_linkages);
+}
 
 
-  if (!get_index_from_handle(FUNCTOR_sentence1, sentence_handle, &sent_handle_index)) { /* Transform the sentence handle into an index */
-    exception=PL_new_term_ref();
-    PL_unify_term(exception,
-		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-		  PL_CHARS, "sentence",
-		  PL_CHARS, "bad_handle");
-    return PL_raise_exception(exception);
-  }
-  else {
-    if (!get_object_from_handle_index_in_chained_list_with_exception_handling("sentence", NULL,
-                                                                              root_sent_list, sent_handle_index, (generic_linked_list_object **)&sent_object)) {
-      PL_fail; /* get_object_from_handle_index_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
-    }
+/**
+ * @name static int same_failed_null_counts_options(failed_null_counts *failed, opts_linked_list_object *opts_object)
+ *
+ * @description
+ * This function returns TRUE if the parse options of opts_object have the same values as the ones with which the range of failed null counts *failed has been found, for all the options that change the outcome of a parse at a given null count
+**/
+
+static int same_failed_null_counts_options(failed_null_counts *failed, opts_linked_list_object *opts_object) {
+
+Parse_Options opts = opts_object->payload;
+
+  return (failed->disjunct_cost == parse_options_get_disjunct_cost(opts) &&
+          failed->linkage_limit == parse_options_get_linkage_limit(opts) &&
+          failed->null_block == parse_options_get_null_block(opts) &&
+          failed->islands_ok == parse_options_get_islands_ok(opts) &&
+          failed->all_short_connectors == parse_options_get_all_short_connectors(opts) &&
+          failed->allow_null == parse_options_get_allow_null(opts));
+}
+
+
+/**
+ * @name static void record_failed_null_counts(failed_null_counts *failed, opts_linked_list_object *opts_object, int first_null_count, int end_null_count)
+ *
+ * @description
+ * This procedure records that the null counts from first_null_count to end_null_count-1 give no valid linkage with the parse options of opts_object
+ * The range is merged with the one already recorded if they have been found with the same parse options and overlap, otherwise it replaces it
+**/
+
+static void record_failed_null_counts(failed_null_counts *failed, opts_linked_list_object *opts_object, int first_null_count, int end_null_count) {
+
+Parse_Options opts = opts_object->payload;
+
+  if (end_null_count <= first_null_count) return; /* Nothing learnt */
+  if (failed->first_null_count < failed->end_null_count && same_failed_null_counts_options(failed, opts_object) &&
+      first_null_count <= failed->end_null_count && failed->first_null_count <= end_null_count) {
+    if (first_null_count < failed->first_null_count) failed->first_null_count = first_null_count;
+    if (end_null_count > failed->end_null_count) failed->end_null_count = end_null_count;
+    return;
+  }
+  failed->first_null_count = first_null_count;
+  failed->end_null_count = end_null_count;
+  failed->disjunct_cost = parse_options_get_disjunct_cost(opts);
+  failed->linkage_limit = parse_options_get_linkage_limit(opts);
+  failed->null_block = parse_options_get_null_block(opts);
+  failed->islands_ok = parse_options_get_islands_ok(opts);
+  failed->all_short_connectors = parse_options_get_all_short_connectors(opts);
+  failed->allow_null = parse_options_get_allow_null(opts);
+}
+
+
+/**
+ * @name static Sentence take_sentence_for_parse(sent_linked_list_object *sent_object)
+ *
+ * @description
+ * The lgp library only keeps the result of the last sentence_parse() call inside a sentence, and linkage_create() works on this last result
+ * This function returns a sentence that can be parsed without replacing the parse used by a linkage set: the sentence of sent_object if no linkage set uses it, otherwise a new sentence created from the same text and with the same dictionary
+ * The sentence returned must be given back with give_back_sentence() once its parse is not used anymore. NULL is returned if a new sentence was needed and couldn't be created
+**/
+
+static Sentence take_sentence_for_parse(sent_linked_list_object *sent_object) {
+
+  if (!sent_object->payload.sentence_in_use) {
+    sent_object->payload.sentence_in_use = TRUE;
+    return sent_object->payload.sentence;
+  }
+  return sentence_create(sent_object->payload.text, sent_object->payload.sentence->dict); /* See linkage_to_compound() concerning this direct access */
+}
+
+
+/**
+ * @name static void give_back_sentence(sent_linked_list_object *sent_object, Sentence sent)
+ *
+ * @description
+ * This procedure gives back a sentence returned by take_sentence_for_parse() for sent_object: the sentence of sent_object can be parsed again, a sentence created for the parse is deleted
+**/
+
+static void give_back_sentence(sent_linked_list_object *sent_object, Sentence sent) {
+
+  if (sent == sent_object->payload.sentence) {
+    sent_object->payload.sentence_in_use = FALSE;
+  }
+  else {
+    sentence_delete(sent);
+  }
+}
+
+
+/**
+ * @name static int parse_sentence(sent_linked_list_object *sent_object, Sentence sent, opts_linked_list_object *opts_object)
+ *
+ * @description
+ * This function runs sentence_parse() on sent, a sentence taken for sent_object with take_sentence_for_parse(), with the parse options of opts_object, after having adapted short_length to the length of the sentence
+ * max_memory is enforced as a budget for this parse only (see run_sentence_parse()). If it is exceeded and panic_mode is set, the sentence is parsed again with the panic settings of the link-parser program (short connectors, null links allowed), that need much less memory
+ * Null counts that a previous parse of the sentence with the same parse options has found to give no valid linkage are not tried again: min_null_count is raised above them for this parse (see failed_null_counts), without going over max_null_count nor over the length of the sentence, and set back to its value right after the parse. If they cover all the null counts that can be tried, only the last one is tried, so that the sentence holds the same result as after a full parse
+ * This is the only thing a parse takes from the previous ones: the lgp library keeps no disjunct nor counting table from one parse to another, so the other null counts are parsed from scratch
+ * The value returned is the one of sentence_parse() (the number of valid linkages), or PARSE_MEMORY_EXCEEDED if the budget has been exceeded (by the panic parse too, if any). last_parse_memory_exceeded tells whether the first parse exceeded it
+**/
+
+static int parse_sentence(sent_linked_list_object *sent_object, Sentence sent, opts_linked_list_object *opts_object) {
+
+Parse_Options opts = opts_object->payload;
+int           memory_budget = parse_options_get_max_memory(opts);
+int           num_linkages;
+int           saved_disjunct_cost, saved_min_null_count, saved_max_null_count, saved_islands_ok, saved_all_short, saved_linkage_limit;
+failed_null_counts *failed = &sent_object->payload.failed_null_counts;
+int           min_null_count = parse_options_get_min_null_count(opts);
+int           max_null_count = parse_options_get_max_null_count(opts);
+int           first_null_count = min_null_count; /* Null count from which the parse starts */
+
+  if (sentence_length(sent) > min_short_sent_len) {
+    parse_options_set_short_length(opts, 6);
+  }
+  else {
+    parse_options_set_short_length(opts, max_sentence_length);
+  }
+  if (failed->first_null_count <= min_null_count && min_null_count < failed->end_null_count && same_failed_null_counts_options(failed, opts_object)) {
+    first_null_count = (failed->end_null_count <= max_null_count ? failed->end_null_count : max_null_count);
+    if (first_null_count > sentence_length(sent)) first_null_count = sentence_length(sent); /* A linkage never has more null links than words */
+    parse_options_set_min_null_count(opts, first_null_count);
+  }
+  num_linkages = run_sentence_parse(sent, opts, memory_budget);
+  parse_options_set_min_null_count(opts, min_null_count);
+  last_parse_memory_exceeded = (num_linkages == PARSE_MEMORY_EXCEEDED);
+  if (!last_parse_memory_exceeded && !parse_options_timer_expired(opts) && first_null_count <= max_null_count) { /* The null counts have been tried in turn up to the one of the result */
+    record_failed_null_counts(failed, opts_object, min_null_count, (num_linkages > 0 ? sentence_null_count(sent) : sentence_null_count(sent)+1));
+  }
+
+  if (last_parse_memory_exceeded && parse_options_get_panic_mode(opts)) { /* Same panic settings as in the link-parser program (parse.c) */
+    saved_disjunct_cost = parse_options_get_disjunct_cost(opts);
+    saved_min_null_count = parse_options_get_min_null_count(opts);
+    saved_max_null_count = parse_options_get_max_null_count(opts);
+    saved_islands_ok = parse_options_get_islands_ok(opts);
+    saved_all_short = parse_options_get_all_short_connectors(opts);
+    saved_linkage_limit = parse_options_get_linkage_limit(opts);
+    parse_options_set_disjunct_cost(opts, 3);
+    parse_options_set_min_null_count(opts, 1);
+    parse_options_set_max_null_count(opts, MAX_SENTENCE);
+    parse_options_set_islands_ok(opts, 1);
+    parse_options_set_short_length(opts, 6);
+    parse_options_set_all_short_connectors(opts, 1);
+    parse_options_set_linkage_limit(opts, 100);
+    num_linkages = run_sentence_parse(sent, opts, memory_budget);
+    parse_options_set_disjunct_cost(opts, saved_disjunct_cost);
+    parse_options_set_min_null_count(opts, saved_min_null_count);
+    parse_options_set_max_null_count(opts, saved_max_null_count);
+    parse_options_set_islands_ok(opts, saved_islands_ok);
+    parse_options_set_all_short_connectors(opts, saved_all_short);
+    parse_options_set_linkage_limit(opts, saved_linkage_limit);
+  }
+  return num_linkages;
+}
+
+
+/**
+ * @name static Linkage create_linkage_from_set(link_linked_list_object *link_object, int linkage_index)
+ *
+ * @description
+ * This function runs linkage_create() for the linkage number linkage_index of the linkage set link_object
+ * The linkage is created from the sentence that holds the parse of the linkage set
+**/
+
+static Linkage create_linkage_from_set(link_linked_list_object *link_object, int linkage_index) {
+
+  return linkage_create(linkage_index, link_object->payload.sentence, link_object->payload.associated_parse_options_chained_object->payload);
+}
+
+
+/**
+ * @name static void restrict_output_format_to_linkage_set(link_linked_list_object *link_object, linkage_output_format *format)
+ *
+ * @description
+ * Linkages created with a dictionary that has no post-processing knowledge (see post_process(false) in create_dictionary/2) have no domains
+ * This function removes the domains from the fields of *format in that case, so that they are left unbound in the linkage compounds and the lgp library is not queried for them
+**/
+
+static void restrict_output_format_to_linkage_set(link_linked_list_object *link_object, linkage_output_format *format) {
+
+  if (link_object->payload.sentence->dict->postprocessor == NULL) /* See linkage_to_compound() concerning this direct access */
+    format->fields &= ~OUTPUT_FIELD_DOMAINS;
+}
+
+
+/**
+ * @name pl_create_linkage_set(term_t sentence_handle, term_t parse_options_handle, term_t linkage_set_handle)
+ * @prologname create_linkage_set/3
+ *
+ * @description
+ * This function creates a new linkage set from a sentence
+ * Note: This linkage set object will consist in the number of linkages found, together with the sentence used and the options.
+ * It's with the linkage_set_handle returned that the user can use the non-deterministic predicate get_linkage/2
+ * Several linkage sets can be created on the same sentence: the first one keeps its parse in the sentence of the sentence object, the next ones in a sentence of their own (see take_sentence_for_parse())
+**/
+
+foreign_t pl_create_linkage_set(term_t sentence_handle, term_t parse_options_handle, term_t linkage_set_handle) {
+
+term_t                  exception; /* Handle for an possible exception */
+unsigned int            new_handle_index; /* Variable to store the handle index referencing the new linkage set in the chained list */
+link_linked_list_object *chained_new_linkage_set_object;
+unsigned int            sent_handle_index; /* Handle index for the sentence used */
+sent_linked_list_object *sent_object; /* Linked object (corresponding to the handle given as parameter) in the sentence chained-list */
+Sentence                sent; /* Sentence of the sentence object */
+Sentence                parsed_sent; /* Sentence holding the parse of the new linkage set (see take_sentence_for_parse()) */
+unsigned int            opts_handle_index; /* Handle index for the parse options used */
+opts_linked_list_object *opts_object; /* Linked object (corresponding to the handle given as parameter) in the parse options chained-list */
+Parse_Options           opts; /* Parse options object attached to the new linkage set */
+int                     num_linkages; /* Number of linkages computed from the sentence and parse options */
+parse_statistics        statistics; /* Measures taken during sentence_parse() */
+clock_t                 parse_start; /* CPU clock when sentence_parse() was called */
+int                     saved_max_space_in_use; /* Overall peak of memory used by the lgp library before the parse */
+int                     space_before_parse; /* Memory used by the lgp library before the parse */
+
+
+
+  if (!get_index_from_handle(FUNCTOR_sentence1, sentence_handle, &sent_handle_index)) { /* Transform the sentence handle into an index */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  else {
+    if (!get_object_from_handle_index_in_chained_list_with_exception_handling("sentence", NULL,
+                                                                              root_sent_list, sent_handle_index, (generic_linked_list_object **)&sent_object)) {
+      PL_fail; /* get_object_from_handle_index_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
+    }
     else { /* Function executed successfully */
       sent_object->count_references++; /* One more reference to this sentence object has been done. Update the sentence object accordingly */
       sent = sent_object->payload.sentence; /* Get a pointer on the sentence corresponding to the handle given as parameter */
@@ -1798,16 +2638,45 @@ int                     num_linkages; /* Number of linkages computed from the se
     return PL_raise_exception(exception);
   }
   
-  if (sentence_length(sent) > min_short_sent_len) {
-    parse_options_set_short_length(opts, 6);
-  }
-  else {
-    parse_options_set_short_length(opts, max_sentence_length);
+  if ((parsed_sent = take_sentence_for_parse(sent_object)) == NULL) {
+    sent_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object won't be created */
+    opts_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object won't be created */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "not_enough_memory");
+    return PL_raise_exception(exception);
   }
 
-  num_linkages = sentence_parse(sent, opts);
+  saved_max_space_in_use = max_space_in_use;
+  space_before_parse = space_in_use;
+  max_space_in_use = space_in_use; /* Reset the peak so that it only reflects this parse */
+  parse_start = clock();
+  num_linkages = parse_sentence(sent_object, parsed_sent, opts_object);
+  statistics.parse_time = (double)(clock() - parse_start) / CLOCKS_PER_SEC;
+  statistics.peak_memory = (long)max_space_in_use - (long)space_before_parse;
+  if (max_space_in_use < saved_max_space_in_use) max_space_in_use = saved_max_space_in_use; /* Restore the overall peak */
+  statistics.num_linkages_found = sentence_num_linkages_found(parsed_sent);
+  statistics.num_valid_linkages = sentence_num_valid_linkages(parsed_sent);
+  statistics.null_count = sentence_null_count(parsed_sent);
+  statistics.timer_expired = parse_options_timer_expired(opts);
+  statistics.memory_exhausted = last_parse_memory_exceeded;
+
+  if (num_linkages==PARSE_MEMORY_EXCEEDED) { /* The parse has been aborted, and no panic parse could be done within the max_memory budget either */
+    give_back_sentence(sent_object, parsed_sent);
+    sent_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object won't be created */
+    opts_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object won't be created */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse",
+		  PL_CHARS, "memory_exceeded");
+    return PL_raise_exception(exception);
+  }
   
   if (num_linkages==0) { /* No linkages for this sentence, this predicate will fail */
+    give_back_sentence(sent_object, parsed_sent);
     sent_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object won't be created */
     opts_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object won't be created */
     PL_fail;
@@ -1819,6 +2688,7 @@ int                     num_linkages; /* Number of linkages computed from the se
                                                              NB_LINKAGE_SETS-1,
                                                              &new_handle_index,
                                                              (generic_linked_list_object **)&chained_new_linkage_set_object)) {
+    give_back_sentence(sent_object, parsed_sent);
     sent_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object won't be created */
     opts_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object won't be created */
     PL_fail; /* create_object_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
@@ -1829,6 +2699,7 @@ int                     num_linkages; /* Number of linkages computed from the se
   /* We first make sure that we can unify the handle for the new linkage set */
   if (!unify_handle_with_index(FUNCTOR_linkageset1, linkage_set_handle, new_handle_index)) {
     delete_object_in_chained_list(root_link_list, new_handle_index);
+    give_back_sentence(sent_object, parsed_sent);
     sent_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object won't be created */
     opts_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object won't be created */
     exception=PL_new_term_ref();
@@ -1842,14 +2713,157 @@ int                     num_linkages; /* Number of linkages computed from the se
   /* We now have to fill-in the fields of its payload structure */
   
   chained_new_linkage_set_object->payload.num_linkages = num_linkages;
+  chained_new_linkage_set_object->payload.statistics = statistics;
+  chained_new_linkage_set_object->payload.sentence = parsed_sent;
   chained_new_linkage_set_object->payload.associated_sentence_chained_object = sent_object;
   chained_new_linkage_set_object->payload.associated_parse_options_chained_object = opts_object;
+  chained_new_linkage_set_object->payload.owns_parse_options = FALSE; /* See pl_reparse_linkage_set() */
   chained_new_linkage_set_object->payload.associated_context_list = NULL; /* This is a new linkage set object, so no pl_get_linkage call on this linkage set has been made yet. No context has been created in pl_get_linkage, so this list is empty for now */
 
   PL_succeed; /* The handle has been successfully created, so succeed */
 }
 
 
+/**
+ * @name pl_reparse_linkage_set(term_t linkage_set_handle, term_t parse_options_handle, term_t new_linkage_set_handle)
+ * @prologname reparse_linkage_set_/3
+ *
+ * @description
+ * This function creates a new linkage set from the sentence of the linkage set linkage_set_handle, parsed again with the parse options parse_options_handle (see reparse_linkage_set/3 in lgp.pl)
+ * The sentence object is shared with the original linkage set, so the null counts found to give no valid linkage by its previous parses are skipped when the parse options allow it (see parse_sentence())
+ * The new linkage set then holds a private copy of the parse options, out of the parse options chained-list, that is deleted together with it. The parse options object parse_options_handle is left to the caller (reparse_linkage_set/3 deletes it right away), so the new linkage set doesn't take one of the NB_PARSE_OPTIONS slots
+ * Like create_linkage_set/3, this predicate fails if the sentence has no linkage with these parse options
+ * The original linkage set keeps its parse, so both linkage sets can create linkages (see take_sentence_for_parse())
+**/
+
+foreign_t pl_reparse_linkage_set(term_t linkage_set_handle, term_t parse_options_handle, term_t new_linkage_set_handle) {
+
+term_t                  exception;
+term_t                  sentence_handle = PL_new_term_ref(); /* Handle of the sentence of the original linkage set */
+unsigned int            handle_index;
+unsigned int            sent_handle_index;
+link_linked_list_object *link_object; /* Original linkage set */
+link_linked_list_object *new_link_object;
+opts_linked_list_object *opts_object; /* Parse options object of parse_options_handle, used for the parse */
+opts_linked_list_object *private_opts_object; /* Copy of *opts_object owned by the new linkage set */
+
+
+  if (!get_index_from_handle(FUNCTOR_linkageset1, linkage_set_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("linkage_set", NULL, root_link_list, handle_index, (generic_linked_list_object **)&link_object)) {
+    PL_fail; /* Return the exception prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  if (!get_handle_index_from_object_in_chained_list_with_exception_handling("sentence", NULL,
+                                                                            (generic_linked_list_object *)root_sent_list,
+                                                                            &sent_handle_index,
+                                                                            (generic_linked_list_object *)(link_object->payload.associated_sentence_chained_object))) {
+    PL_fail;
+  }
+  if (!unify_handle_with_index(FUNCTOR_sentence1, sentence_handle, sent_handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "cant_create_handle");
+    return PL_raise_exception(exception);
+  }
+
+  if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+    PL_fail; /* Return the exception prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  if ((private_opts_object = malloc(sizeof(opts_linked_list_object))) == NULL ||
+      (private_opts_object->payload = copy_parse_options(opts_object->payload)) == NULL) {
+    free(private_opts_object);
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "cant_register");
+    return PL_raise_exception(exception);
+  }
+  private_opts_object->next = NULL; /* Not in the parse options chained-list */
+  private_opts_object->nb_jumped_index = 0;
+  private_opts_object->count_references = 1; /* Referenced by the new linkage set only */
+  private_opts_object->session = opts_object->session;
+
+  if (!pl_create_linkage_set(sentence_handle, parse_options_handle, new_linkage_set_handle)) {
+    delete_parse_options_object_payload(private_opts_object);
+    free(private_opts_object);
+    PL_fail; /* No linkage, or an exception has been prepared by pl_create_linkage_set() */
+  }
+  copy_parse_options_values(private_opts_object->payload, opts_object->payload); /* Values as left by the parse (see parse_sentence()) */
+  if (get_index_from_handle(FUNCTOR_linkageset1, new_linkage_set_handle, &handle_index) &&
+      get_object_from_handle_index_in_chained_list(root_link_list, handle_index, (generic_linked_list_object **)&new_link_object) == 0) {
+    opts_object->count_references--; /* The new linkage set doesn't use parse_options_handle anymore */
+    new_link_object->payload.associated_parse_options_chained_object = private_opts_object;
+    new_link_object->payload.owns_parse_options = TRUE;
+  }
+  else { /* Can't happen, the handle has just been created */
+    delete_parse_options_object_payload(private_opts_object);
+    free(private_opts_object);
+  }
+  PL_succeed;
+}
+
+
+/**
+ * @name pl_copy_linkage_set_parse_options(term_t linkage_set_handle, term_t parse_options_handle)
+ * @prologname copy_linkage_set_parse_options_/2
+ *
+ * @description
+ * This function gives to the parse options object parse_options_handle the values of the parse options with which the linkage set linkage_set_handle has been parsed (see reparse_linkage_set/3 in lgp.pl)
+ * It also works for the linkage sets created by reparse_linkage_set/3, whose parse options have no handle
+**/
+
+foreign_t pl_copy_linkage_set_parse_options(term_t linkage_set_handle, term_t parse_options_handle) {
+
+term_t                  exception;
+unsigned int            handle_index;
+link_linked_list_object *link_object;
+opts_linked_list_object *opts_object; /* Parse options object to set */
+
+
+  if (!get_index_from_handle(FUNCTOR_linkageset1, linkage_set_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("linkage_set", NULL, root_link_list, handle_index, (generic_linked_list_object **)&link_object)) {
+    PL_fail; /* Return the exception prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+    PL_fail; /* Return the exception prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  copy_parse_options_values(opts_object->payload, link_object->payload.associated_parse_options_chained_object->payload);
+  PL_succeed;
+}
+
+
 /**
  * @name void delete_linkage_set_object_payload(link_linked_list_object *link_object)
  *
@@ -1862,9 +2876,16 @@ void delete_linkage_set_object_payload(link_linked_list_object *link_object) {
 
 context_list *context_ptr, *next_context_ptr;
 
+  give_back_sentence(link_object->payload.associated_sentence_chained_object, link_object->payload.sentence);
+  link_object->payload.sentence = NULL;
   link_object->payload.associated_sentence_chained_object->count_references--; /* Remove the reference to the sentence object given that the linkage set object is deleted */
   link_object->payload.associated_parse_options_chained_object->count_references--; /* Remove the reference to the parse options object given that the linkage set object is deleted */
   link_object->payload.num_linkages = 0; /* This is to make sure that the object is clean... but it will be deleted anyway! */
+  if (link_object->payload.owns_parse_options) { /* Private parse options, out of the parse options chained-list (see pl_reparse_linkage_set()) */
+    delete_parse_options_object_payload(link_object->payload.associated_parse_options_chained_object);
+    free(link_object->payload.associated_parse_options_chained_object);
+    link_object->payload.associated_parse_options_chained_object = NULL;
+  }
   
   context_ptr=link_object->payload.associated_context_list; /* Get the root of the context list */
   
@@ -1874,9 +2895,11 @@ context_list *context_ptr, *next_context_ptr;
     context_ptr->context_associated_to_link->link_handle_index = -1; /* Cancel the handle_index, meaning that this context has no value anymore, because the linkage set it relates to has been deleted */
     next_context_ptr = context_ptr->next;
 /* We don't free up the context object here, because it's not up to linkage set to handle this, but to pl_get_linkage, when executed (redone, or cut) */
-    exfree(context_ptr, sizeof(context_list)); /* We free up context_ptr in the context chained list associate to the linkage set, because, this is, however, the linkage set's structure */
+    context_ptr->next = NULL; /* The node is embedded in the context, just detach it from the list */
+    context_ptr->previous = NULL;
     context_ptr = next_context_ptr; /* Continue on the next item of the list, if any */
   }
+  link_object->payload.associated_context_list = NULL;
 /* No further cleanup is needed given that linkage set objects don't have a physical structure allocated in LGP */
 }
 
@@ -2092,6 +3115,7 @@ link_linked_list_object *link_object; /* Pointer to the linkage set object in th
  *
  * @description
  * This function returns a list containing all the handles and values associated to a linkage set object
+ * parse_options_handle is none for a linkage set created by reparse_linkage_set/3, whose parse options are private (see pl_reparse_linkage_set())
 **/
 
 foreign_t pl_get_parameters_for_linkage_set(term_t linkage_set_handle, term_t parameter_list) {
@@ -2181,7 +3205,10 @@ link_linked_list_object *link_object; /* Pointer to the linkage set object in th
 
 /* The following will get the handle index of the parse options referenced by this linkage set */
 /* To do so, we use the function get_handle_index_from_object_in_chained_list_with_exception_handling that will scan the parse options chained-list to find the first object that corresponds to the reference stored inside the structure in the linkage set object */
-  if (!get_handle_index_from_object_in_chained_list_with_exception_handling("parse_options", &result,
+  if (link_object->payload.owns_parse_options) {
+    PL_put_atom_chars(parse_options_handle, "none"); /* Private parse options have no handle */
+  }
+  else if (!get_handle_index_from_object_in_chained_list_with_exception_handling("parse_options", &result,
                                                                             (generic_linked_list_object *)root_opts_list,
                                                                             &opts_handle_index,
                                                                             (generic_linked_list_object *)(link_object->payload.associated_parse_options_chained_object)
@@ -2195,7 +3222,7 @@ link_linked_list_object *link_object; /* Pointer to the linkage set object in th
     }
     PL_fail; /* handle_index_from_object_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
   }
-  if (!unify_handle_with_index(FUNCTOR_options1, parse_options_handle, opts_handle_index)) { /* Create a term containing the handle for the parse options associated with our linkage set object */
+  else if (!unify_handle_with_index(FUNCTOR_options1, parse_options_handle, opts_handle_index)) { /* Create a term containing the handle for the parse options associated with our linkage set object */
     exception=PL_new_term_ref();
     PL_unify_term(exception,
 		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
@@ -2224,37 +3251,314 @@ link_linked_list_object *link_object; /* Pointer to the linkage set object in th
 
 
 /**
- * @name pl_create_sentence(term_t t_input_sentence, term_t dictionary_handle, term_t sentence_handle)
+ * @name pl_get_linkage_set_statistics(term_t linkage_set_handle, term_t statistics_list)
+ * @prologname get_linkage_set_statistics/2
  *
  * @description
- * This function creates a new sentence using the text contained by the t_input_sentence term. The handle for the newly created sentence is bound with sentence_handle
+ * This function returns the measures taken while parsing the sentence of a linkage set, as a list of Name=Value terms:
+ * [parse_time=Seconds, peak_memory=Bytes, linkages_found=N, valid_linkages=N, null_count=N, timer_expired=Bool, memory_exhausted=Bool]
+ * These are measures of the whole parse only: the count table of the lgp library (count.c) is out of reach of the binding, so no hit or probe counts are given
 **/
 
-foreign_t pl_create_sentence(term_t t_input_sentence, term_t dictionary_handle, term_t sentence_handle) {
-
-term_t                   exception; /* Handle for an possible exception */
-unsigned int            new_handle_index; /* Variable to store the handle index referencing the new sentence object in the chained list */
-Sentence                new_sentence; /* The new sentence object created (internal LGP object) */
-sent_linked_list_object *chained_new_sentence_object;
-unsigned int            dict_handle_index; /* Handle index for the dictionary used */
-Dictionary              dict; /* Dictionary object */
-dict_linked_list_object *dict_object; /* Linked object corresponding to the handle, in the dictionary chained-list */
-char                    *input_sentence; /* Input sentence given as parameter */
-
+foreign_t pl_get_linkage_set_statistics(term_t linkage_set_handle, term_t statistics_list) {
 
-  if (!PL_get_atom_chars(t_input_sentence, &input_sentence)) {
-    exception=PL_new_term_ref(); /* Create a new exception object */
-    PL_unify_term(exception,
-		  PL_CHARS, "instanciation_fault"); /* Fill-in the exception object */
-    return PL_raise_exception(exception); /* Raise the exception and exit */
-  }
+term_t                  constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t                  new_element = PL_new_term_ref(); /* Term used to construct each Name=Value element */
+term_t                  exception;
+unsigned int            handle_index;
+link_linked_list_object *link_object; /* Pointer to the linkage set object in the chained list */
+parse_statistics        *statistics;
 
 
-  if (!get_index_from_handle(FUNCTOR_dictionary1, dictionary_handle, &dict_handle_index)) {
-    exception = PL_new_term_ref();
+  if (!get_index_from_handle(FUNCTOR_linkageset1, linkage_set_handle, &handle_index)) {
+    exception=PL_new_term_ref();
     PL_unify_term(exception,
 		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-		  PL_CHARS, "dictionary",
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("linkage_set", NULL, root_link_list, handle_index, (generic_linked_list_object **)&link_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  statistics = &link_object->payload.statistics;
+
+  PL_put_nil(constructed_list); /* Create the tail of the list (which is []), elements are then added from the last to the first one */
+  if (!(PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "memory_exhausted", PL_CHARS, (statistics->memory_exhausted ? "true" : "false")) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "timer_expired", PL_CHARS, (statistics->timer_expired ? "true" : "false")) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "null_count", PL_INT, statistics->null_count) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "valid_linkages", PL_INT, statistics->num_valid_linkages) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "linkages_found", PL_INT, statistics->num_linkages_found) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "peak_memory", PL_LONG, statistics->peak_memory) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "parse_time", PL_FLOAT, statistics->parse_time) &&
+        PL_cons_list(constructed_list, new_element, constructed_list))) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "cant_create_statistics_term");
+    return PL_raise_exception(exception);
+  }
+
+  return PL_unify(statistics_list, constructed_list);
+}
+
+
+/**
+ * @name pl_sentence_accepts(term_t sentence_handle, term_t parse_options_handle, term_t info_list)
+ * @prologname sentence_accepts/3
+ *
+ * @description
+ * This function tells whether a sentence can be parsed with the given parse options, without creating any linkage set object
+ * The sentence is parsed once, with a private copy of the parse options in which linkage_limit is 1: the lgp library then post-processes a single linkage, sampled among the ones found, instead of up to linkage_limit of them. The parse options of parse_options_handle are left untouched
+ * info_list is unified with a list of Name=Value terms: [accepted=Bool, null_count=N, linkages_found=N] followed, if the sentence has been accepted, by [disjunct_cost=N, link_cost=N]
+ * accepted=true tells that the sampled linkage passed post-processing, and the costs are the ones of this linkage. When linkages_found is above 1, accepted=false only tells that the sampled linkage has been rejected: create_linkage_set/3 post-processes up to linkage_limit linkages and can still find valid ones
+ * Linkage sets already created on this sentence keep their parse, as the parse is run on a sentence of its own if one of them uses the sentence (see take_sentence_for_parse())
+**/
+
+foreign_t pl_sentence_accepts(term_t sentence_handle, term_t parse_options_handle, term_t info_list) {
+
+term_t                  constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t                  new_element = PL_new_term_ref(); /* Term used to construct each Name=Value element */
+term_t                  exception;
+unsigned int            handle_index;
+sent_linked_list_object *sent_object; /* Linked object corresponding to the sentence handle */
+opts_linked_list_object *opts_object; /* Linked object corresponding to the parse options handle */
+opts_linked_list_object accept_opts_object; /* Same as *opts_object, with a private copy of its parse options as payload */
+Sentence                sent;
+Parse_Options           opts;
+int                     num_valid_linkages;
+int                     num_linkages_found, null_count, disjunct_cost = 0, link_cost = 0; /* Result of the parse, read before the sentence is given back */
+
+
+  if (!get_index_from_handle(FUNCTOR_sentence1, sentence_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("sentence", NULL, root_sent_list, handle_index, (generic_linked_list_object **)&sent_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  sent = sent_object->payload.sentence;
+  opts = opts_object->payload;
+
+  if (sentence_length(sent) > parse_options_get_max_sentence_length(opts)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "too_long");
+    return PL_raise_exception(exception);
+  }
+
+  accept_opts_object = *opts_object;
+  if ((accept_opts_object.payload = copy_parse_options(opts)) == NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "cant_register");
+    return PL_raise_exception(exception);
+  }
+  parse_options_set_linkage_limit(accept_opts_object.payload, 1); /* Only post-process one linkage */
+  if ((sent = take_sentence_for_parse(sent_object)) == NULL) {
+    parse_options_delete(accept_opts_object.payload);
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "not_enough_memory");
+    return PL_raise_exception(exception);
+  }
+  num_valid_linkages = parse_sentence(sent_object, sent, &accept_opts_object);
+  parse_options_delete(accept_opts_object.payload);
+  if (num_valid_linkages == PARSE_MEMORY_EXCEEDED) {
+    give_back_sentence(sent_object, sent);
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse",
+		  PL_CHARS, "memory_exceeded");
+    return PL_raise_exception(exception);
+  }
+  num_linkages_found = sentence_num_linkages_found(sent);
+  null_count = sentence_null_count(sent);
+  if (num_valid_linkages > 0) { /* Linkages are sorted by the lgp library, the first one is the best one */
+    disjunct_cost = sentence_disjunct_cost(sent, 0);
+    link_cost = sentence_link_cost(sent, 0);
+  }
+  give_back_sentence(sent_object, sent);
+
+  PL_put_nil(constructed_list); /* Create the tail of the list (which is []), elements are then added from the last to the first one */
+  if (num_valid_linkages > 0) {
+    if (!(PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "link_cost", PL_INT, link_cost) &&
+          PL_cons_list(constructed_list, new_element, constructed_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "disjunct_cost", PL_INT, disjunct_cost) &&
+          PL_cons_list(constructed_list, new_element, constructed_list))) {
+      exception=PL_new_term_ref();
+      PL_unify_term(exception,
+		    PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		    PL_CHARS, "sentence",
+		    PL_CHARS, "cant_create_info_term");
+      return PL_raise_exception(exception);
+    }
+  }
+  if (!(PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "linkages_found", PL_INT, num_linkages_found) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "null_count", PL_INT, null_count) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "accepted", PL_CHARS, (num_valid_linkages > 0 ? "true" : "false")) &&
+        PL_cons_list(constructed_list, new_element, constructed_list))) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "cant_create_info_term");
+    return PL_raise_exception(exception);
+  }
+
+  return PL_unify(info_list, constructed_list);
+}
+
+
+/**
+ * @name static char *parse_cost_class(double nb_disjuncts)
+ *
+ * @description
+ * This function returns the predicted time class of the parse of a sentence (cheap, medium or expensive) from its number of disjuncts, as given by lgp_worker_estimate_disjuncts() (see lgp-worker.c)
+**/
+
+static char *parse_cost_class(double nb_disjuncts) {
+
+  if (nb_disjuncts < PARSE_COST_MEDIUM_DISJUNCTS) return "cheap";
+  if (nb_disjuncts < PARSE_COST_EXPENSIVE_DISJUNCTS) return "medium";
+  return "expensive";
+}
+
+
+/**
+ * @name pl_estimate_parse_cost(term_t sentence_handle, term_t parse_options_handle, term_t estimate_list)
+ * @prologname estimate_parse_cost/3
+ *
+ * @description
+ * This function predicts the cost of parsing a sentence with the given parse options, by running the expression pruning only (the sentence has been tokenised by create_sentence/3 already)
+ * estimate_list is unified with a list of Name=Value terms: [words=N, disjuncts=N, cost_class=Class], where disjuncts is the total number of disjuncts of the words after pruning (with the disjunct_cost of the parse options) and Class is cheap, medium or expensive
+ * Linkage sets already created on this sentence remain usable, the pruning is run again by the next parse anyway
+**/
+
+foreign_t pl_estimate_parse_cost(term_t sentence_handle, term_t parse_options_handle, term_t estimate_list) {
+
+term_t                  constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t                  new_element = PL_new_term_ref(); /* Term used to construct each Name=Value element */
+term_t                  exception;
+unsigned int            handle_index;
+sent_linked_list_object *sent_object; /* Linked object corresponding to the sentence handle */
+opts_linked_list_object *opts_object; /* Linked object corresponding to the parse options handle */
+Sentence                sent;
+double                  nb_disjuncts;
+
+
+  if (!get_index_from_handle(FUNCTOR_sentence1, sentence_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("sentence", NULL, root_sent_list, handle_index, (generic_linked_list_object **)&sent_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  sent = sent_object->payload.sentence;
+
+  nb_disjuncts = lgp_worker_estimate_disjuncts(sent, parse_options_get_disjunct_cost(opts_object->payload));
+
+  PL_put_nil(constructed_list); /* Create the tail of the list (which is []), elements are then added from the last to the first one */
+  if (!(PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "cost_class", PL_CHARS, parse_cost_class(nb_disjuncts)) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "disjuncts", PL_LONG, (nb_disjuncts < (double)LONG_MAX ? (long)nb_disjuncts : LONG_MAX)) &&
+        PL_cons_list(constructed_list, new_element, constructed_list) &&
+        PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "words", PL_INT, sentence_length(sent)) &&
+        PL_cons_list(constructed_list, new_element, constructed_list))) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "cant_create_info_term");
+    return PL_raise_exception(exception);
+  }
+
+  return PL_unify(estimate_list, constructed_list);
+}
+
+
+/**
+ * @name pl_create_sentence(term_t t_input_sentence, term_t dictionary_handle, term_t sentence_handle)
+ *
+ * @description
+ * This function creates a new sentence using the text contained by the t_input_sentence term. The handle for the newly created sentence is bound with sentence_handle
+ * The text can be an atom, a string or a code (or char) list
+**/
+
+foreign_t pl_create_sentence(term_t t_input_sentence, term_t dictionary_handle, term_t sentence_handle) {
+
+term_t                   exception; /* Handle for an possible exception */
+unsigned int            new_handle_index; /* Variable to store the handle index referencing the new sentence object in the chained list */
+Sentence                new_sentence; /* The new sentence object created (internal LGP object) */
+sent_linked_list_object *chained_new_sentence_object;
+unsigned int            dict_handle_index; /* Handle index for the dictionary used */
+Dictionary              dict; /* Dictionary object */
+dict_linked_list_object *dict_object; /* Linked object corresponding to the handle, in the dictionary chained-list */
+char                    *input_sentence; /* Input sentence given as parameter (atom, string or code list) */
+char                    *text; /* Copy of input_sentence kept in the sentence object */
+
+
+  if (!PL_get_nchars(t_input_sentence, NULL, &input_sentence, TEXT_INPUT_FLAGS)) { /* The sentence is not interned as an atom, so parsing a large corpus doesn't grow the atom table */
+    exception=PL_new_term_ref(); /* Create a new exception object */
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "sentence",
+		  PL_CHARS, "instanciation_fault"); /* Fill-in the exception object */
+    return PL_raise_exception(exception); /* Raise the exception and exit */
+  }
+
+
+  if (!get_index_from_handle(FUNCTOR_dictionary1, dictionary_handle, &dict_handle_index)) {
+    exception = PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "dictionary",
 		  PL_CHARS, "bad_handle");
     return PL_raise_exception(exception);
   }
@@ -2273,8 +3577,10 @@ char                    *input_sentence; /* Input sentence given as parameter */
 
   new_sentence = sentence_create(input_sentence, dict); /* Create the sentence object */
   /* The above line will create the sentence, using the string given through the t_input_sentence term and the dictionary which handle matches with dictionary_handle */
+  text = (new_sentence != NULL ? malloc(strlen(input_sentence)+1) : NULL); /* input_sentence is only valid until the next text conversion */
 
-  if (new_sentence == NULL) { /* Check if the sentence has been successfully created. If not, raise a Prolog exception */
+  if (text == NULL) { /* Check if the sentence has been successfully created. If not, raise a Prolog exception */
+    if (new_sentence != NULL) sentence_delete(new_sentence);
     dict_object->count_references--; /* Remove the reference to the dictionary object given that the sentence object won't be created */
     exception=PL_new_term_ref();
     PL_unify_term(exception,
@@ -2290,12 +3596,20 @@ char                    *input_sentence; /* Input sentence given as parameter */
                                                              NB_SENTENCES-1,
                                                              &new_handle_index,
                                                              (generic_linked_list_object **)&chained_new_sentence_object)) {
+    sentence_delete(new_sentence);
+    free(text);
     dict_object->count_references--; /* Remove the reference to the dictionary object given that the sentence object won't be created */
     PL_fail; /* create_object_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
   }
   
+  acquire_dictionary(dict); /* The dictionary must remain loaded as long as this sentence exists, even if its dictionary object is reloaded */
+
   /* Insert the reference to the Sentence object in the payload of the new chained object */
   chained_new_sentence_object->payload.sentence = new_sentence;
+  chained_new_sentence_object->payload.text = strcpy(text, input_sentence);
+  chained_new_sentence_object->payload.sentence_in_use = FALSE; /* No linkage set yet */
+  chained_new_sentence_object->payload.failed_null_counts.first_null_count = 0; /* No null count known to fail yet */
+  chained_new_sentence_object->payload.failed_null_counts.end_null_count = 0;
 
   /* Record the dictionary used for this sentence inside the new chained object as well */
   chained_new_sentence_object->payload.associated_dictionary_chained_object = dict_object;
@@ -2310,6 +3624,8 @@ char                    *input_sentence; /* Input sentence given as parameter */
   if (!unify_handle_with_index(FUNCTOR_sentence1, sentence_handle, new_handle_index)) {
     dict_object->count_references--; /* Remove the reference to the dictionary object given that the sentence object won't be created */
     sentence_delete(new_sentence);
+    free(text);
+    release_dictionary(dict);
     delete_object_in_chained_list(root_sent_list, new_handle_index); /* Remove the sentence from the chained list because this sentence object has been erased. We don't grab the return value from this function because the exception we will raise will anyway be related to the handle we can't create */
     exception=PL_new_term_ref();
     PL_unify_term(exception,
@@ -2330,15 +3646,22 @@ char                    *input_sentence; /* Input sentence given as parameter */
  * @description
  * This procedure will free up the memory for the sentence pointer contained in a sentence-chained-list object (sent_object)
  * This is made in a way that it is called as the "payload_handling_procedure" procedure of a call to the delete_[all_]object[s]_in_chained_list_with_payload_handling (check these procedures above for more information)
+ * The Sentence is deleted rather than kept for a next sentence object: the lgp library has no entry point to tokenize a new text into an existing Sentence, so it couldn't be reused
 **/
 
 void delete_sentence_object_payload(sent_linked_list_object *sent_object) {
 
+Dictionary dict;
+
   sent_object->payload.associated_dictionary_chained_object->count_references--; /* Remove the reference to the dictionary object given that the sentence object is deleted */
   if ( sent_object->payload.sentence != NULL) {
+    dict = sent_object->payload.sentence->dict; /* The dictionary this sentence has been created with (see linkage_to_compound() concerning this direct access). It can be an older one than the payload of the dictionary object, if it has been reloaded since */
     sentence_delete(sent_object->payload.sentence); /* Delete the sentence in the lgp API */
     sent_object->payload.sentence = NULL; /* Reset the pointer to the payload (that doesn't exist anymore!) */
+    release_dictionary(dict);
   }
+  free(sent_object->payload.text);
+  sent_object->payload.text = NULL;
 }
 
 
@@ -3095,13 +4418,14 @@ foreign_t pl_disable_panic_on_parse_options(term_t parse_options_handle) {
 
 
 /**
- * @name word_to_term(char *word_string, term_t word_term)
+ * @name word_to_term(char *word_string, int word_index, linkage_output_format *format, term_t word_term)
  *
  * @description
  * This function parses the word_string C-type string and unifies the word_term term with a compound term gathering the information for Prolog
+ * With the word_format(string) output option, the compound is w(word_index, "Word", Type) and no atom nor functor is created for the word itself
 **/
 
-static int word_to_term(char *word_string, term_t word_term) {
+static int word_to_term(char *word_string, int word_index, linkage_output_format *format, term_t word_term) {
 
 char      *word_name;
 char      *word_type;
@@ -3110,6 +4434,23 @@ functor_t word_name_functor;
 term_t    word_type_term = PL_new_term_ref();
 
  
+  if (format->word_format == WORD_FORMAT_STRING) {
+    PL_put_variable(word_term); /* word_term can be reused by the caller from one link to the next one */
+    for (cs=word_string; *cs!='\0' && *cs!='.'; cs++); /* Look for the start of the type part (if any) */
+    if (*cs=='.')
+      return PL_unify_term(word_term,
+                           PL_FUNCTOR, FUNCTOR_w3,
+                           PL_INT, word_index,
+                           PL_NSTRING, (size_t)(cs-word_string), word_string,
+                           PL_CHARS, cs+1);
+    else
+      return PL_unify_term(word_term,
+                           PL_FUNCTOR, FUNCTOR_w3,
+                           PL_INT, word_index,
+                           PL_STRING, word_string,
+                           PL_VARIABLE);
+  }
+
   word_name=exalloc(strlen(word_string)+1);
   for (cs=word_string, cd=word_name; *cs; cs++, cd++)
     *cd=(isupper(*cs) ? tolower(*cs) : *cs); /* Lower case for the word and copy inside word_string_copy */
@@ -3141,13 +4482,144 @@ term_t    word_type_term = PL_new_term_ref();
 
 
 /**
- * @name create_connector(char *connector_string, term_t connector_term)
+ * @name static compiled_connector *find_compiled_connector(char *connector_string, compiled_connector **free_slot)
+ *
+ * @description
+ * This function looks-up connector_string in compiled_connector_table without compiling it, and returns its slot, or NULL if the label has never been seen
+ * In this last case, free_slot (if not NULL) receives the slot where the label is to be compiled, or NULL if the table is full
+**/
+
+static compiled_connector *find_compiled_connector(char *connector_string, compiled_connector **free_slot) {
+
+unsigned int       hash = 5381;
+unsigned int       probe;
+compiled_connector *compiled;
+char               *cs;
+
+  for (cs=connector_string; *cs; cs++)
+    hash = (hash << 5) + hash + (unsigned char)*cs; /* djb2 hash on the label */
+
+  if (free_slot != NULL) *free_slot = NULL;
+  for (probe=0; probe<NB_COMPILED_CONNECTORS; probe++) { /* Linear probing */
+    compiled = &compiled_connector_table[(hash + probe) & (NB_COMPILED_CONNECTORS-1)];
+    if (compiled->label == NULL) { /* Free slot: the label has never been seen */
+      if (free_slot != NULL) *free_slot = compiled;
+      return NULL;
+    }
+    if (strcmp(compiled->label, connector_string) == 0) return compiled; /* Label already compiled */
+  }
+  return NULL; /* The table is full */
+}
+
+
+/**
+ * @name static compiled_connector *get_compiled_connector(char *connector_string)
+ *
+ * @description
+ * Connector labels come from a small set (the one defined in the dictionary), but linkage_to_compound() converts each of them character per character for each link of each linkage
+ * This function looks-up connector_string in compiled_connector_table (see find_compiled_connector()) and returns the slot holding its precompiled atoms (head and one atom per subscript character), compiling it on first encounter
+ * Only the conversion of the links into Prolog terms benefits from this cache, the lgp library still matches connectors character per character while pruning
+ * NULL is returned when the label can't be stored in the table (table full, subscript too long or out of memory). In this case, the caller must parse connector_string itself
+**/
+
+static compiled_connector *get_compiled_connector(char *connector_string) {
+
+compiled_connector *compiled;
+char               head_name[MAXINPUT]; /* Lower-cased head of the connector */
+char               subscript_name[2]; /* One character subscript atom name */
+char               *cs, *cd; /* String manipulation pointers */
+size_t             length;
+
+  if (find_compiled_connector(connector_string, &compiled) != NULL) return compiled; /* Label already compiled */
+  if (compiled == NULL) return NULL; /* The table is full */
+
+  length = strlen(connector_string);
+  if (length >= MAXINPUT) return NULL;
+
+  compiled->nb_subscripts = 0;
+  for (cs=connector_string, cd=head_name; *cs && !islower(*cs); cs++, cd++)
+    *cd=(isupper(*cs) ? tolower(*cs) : *cs); /* The head is made of all characters before the first lower-case one */
+  *cd='\0';
+  if (strlen(cs) > MAX_CONNECTOR_SUBSCRIPT) return NULL; /* Subscript too long to fit in the table */
+
+  compiled->label = malloc(length+1);
+  if (compiled->label == NULL) return NULL;
+
+  compiled->head = PL_new_atom(head_name);
+  subscript_name[1]='\0';
+  for (; *cs; cs++) {
+    if (*cs=='*')
+      compiled->subscript[compiled->nb_subscripts++] = (atom_t)0; /* '*' will be output as an unbound variable */
+    else {
+      subscript_name[0]=(isupper(*cs) ? tolower(*cs) : *cs);
+      compiled->subscript[compiled->nb_subscripts++] = PL_new_atom(subscript_name);
+    }
+  }
+  strcpy(compiled->label, connector_string); /* Setting the label last marks the slot as used */
+  return compiled;
+}
+
+
+/**
+ * @name static void delete_compiled_connectors()
+ *
+ * @description
+ * Frees up all the entries of compiled_connector_table (the atoms they reference are released as well)
+**/
+
+static void delete_compiled_connectors() {
+
+int slot, i;
+
+  for (slot=0; slot<NB_COMPILED_CONNECTORS; slot++) {
+    if (compiled_connector_table[slot].label == NULL) continue;
+    PL_unregister_atom(compiled_connector_table[slot].head);
+    for (i=0; i<compiled_connector_table[slot].nb_subscripts; i++)
+      if (compiled_connector_table[slot].subscript[i] != (atom_t)0)
+        PL_unregister_atom(compiled_connector_table[slot].subscript[i]);
+    free(compiled_connector_table[slot].label);
+    compiled_connector_table[slot].label = NULL;
+  }
+}
+
+
+/**
+ * @name pl_connector_label(term_t t_label_id, term_t t_label)
+ * @prologname connector_label/2
+ *
+ * @description
+ * This predicate converts a connector label id (as output in the compact linkage format) into the connector label (as a string), or the other way round if t_label_id is unbound
+ * The reverse conversion is a look-up only: it fails for a label that has never been output in the compact format, so that it can't fill the table
+ * Label ids are valid until the foreign library is unloaded
+**/
+
+foreign_t pl_connector_label(term_t t_label_id, term_t t_label) {
+
+int                label_id;
+char               *label;
+compiled_connector *compiled;
+
+  if (PL_get_integer(t_label_id, &label_id)) {
+    if (label_id < 0 || label_id >= NB_COMPILED_CONNECTORS || compiled_connector_table[label_id].label == NULL) PL_fail; /* Unknown label id */
+    return PL_unify_term(t_label, PL_STRING, compiled_connector_table[label_id].label);
+  }
+  if (!PL_get_nchars(t_label, NULL, &label, TEXT_INPUT_FLAGS)) PL_fail;
+  compiled = find_compiled_connector(label, NULL);
+  if (compiled == NULL) PL_fail; /* Unknown label */
+  return PL_unify_integer(t_label_id, (int)(compiled - compiled_connector_table));
+}
+
+
+/**
+ * @name create_connector(char *connector_string, linkage_output_format *format, term_t connector_term)
  *
  * @description
  * This function parses the connector_string C-type string and unifies the connector_term term with the compound result
+ * The label is looked-up in the table of compiled connectors first, so that it is only parsed the first time it is encountered
+ * With the connector_format(string) output option, connector_term is simply unified with connector_string as a Prolog string
 **/
 
-static int create_connector(char *connector_string, term_t connector_term) {
+static int create_connector(char *connector_string, linkage_output_format *format, term_t connector_term) {
   
 char     *connector_name;
 char     *connector_name_end;
@@ -3156,7 +4628,29 @@ term_t   connector_name_term = PL_new_term_ref();
 term_t   new_connector_subscript_element = PL_new_term_ref();
 term_t   constructed_connector_subscript_list = PL_new_term_ref();
 char     *cs, *cd; /* String manipulation pointers */
+compiled_connector *compiled;
+int      i;
+
+  if (format->connector_format == CONNECTOR_FORMAT_STRING) {
+    PL_put_variable(connector_term); /* connector_term can be reused by the caller from one link to the next one */
+    return PL_unify_term(connector_term, PL_STRING, connector_string);
+  }
 
+  compiled = get_compiled_connector(connector_string);
+  if (compiled != NULL) { /* Fast path: just build the term from the precompiled atoms */
+    PL_put_nil(constructed_connector_subscript_list);
+    for (i=compiled->nb_subscripts; i--; ) { /* Tail-to-head list construction */
+      if (compiled->subscript[i] == (atom_t)0)
+        PL_put_variable(new_connector_subscript_element);
+      else
+        PL_put_atom(new_connector_subscript_element, compiled->subscript[i]);
+      PL_cons_list(constructed_connector_subscript_list, new_connector_subscript_element, constructed_connector_subscript_list);
+    }
+    PL_put_atom(connector_name_term, compiled->head);
+    PL_put_functor(connector_term, FUNCTOR_hyphen2);
+    return (PL_unify_arg(1, connector_term, connector_name_term) &&
+            PL_unify_arg(2, connector_term, constructed_connector_subscript_list));
+  }
   
   connector_name=exalloc(strlen(connector_string)+1); /* Allocate a temporary working string */
   
@@ -3196,37 +4690,141 @@ char     *cs, *cd; /* String manipulation pointers */
 
 
 /**
- * @name linkage_to_compound(Linkage linkage, term_t links_list)
+ * @name static int raise_connector_table_full()
  *
  * @description
- * This function creates a Prolog compund term gathering all the information that could be got from the linkage object (domains, links, names of words, type of words...)
- * When exiting, all the information is contained inside the Prolog term links_list, that is to say that NO MEMORY is used by temporary objects after returning from this function. It's up to the Prolog engine to take care (detecting obsolescence, and releasing unused memory) of the links_list term and all the nested terms it includes.
- * Here is a summary of what is sent back as a the links_list Prolog term:
- * Sentence: The house is in the middle of my garden
- * A call to linkage_print_links_and_domains(linkage) would return the following C-string:
- *       LEFT-WALL      RW      <-RW->  RW        RIGHT-WALL
- * (m)   LEFT-WALL      Wd      <-Wd->  Wd        house.n
- * (m)   the            D       <-Ds->  Ds        house.n
- * (m)   house.n        Ss      <-Ss->  Ss        is.v
- * (m)   is.v           Pp      <-Pp->  Pp        in
- * (m)   in             J       <-Js->  Js        middle.n
- * (m)   the            D       <-Ds->  Ds        middle.n
- * (m)   middle.n       M       <-Mp->  Mp        of
- * (m)   of             J       <-Js->  Js        garden.n
- * (m)   my             D       <-Ds->  Ds        garden.n
- * And a call to linkage_to_compound(Linkage linkage, term_t links_list) will return the following term, inside links_list:
- * [link( [m], connection(d-[s], my(_G1717),  garden(n)) ),
- *  link( [m], connection(j-[s], of(_G1694),  garden(n)) ),
- *  link( [m], connection(m-[p], middle(n),   of(_G1669)) ),
- *  link( [m], connection(d-[s], the(_G1648), middle(n)) ),
- *  link( [m], connection(j-[s], in(_G1625),  middle(n)) ),
- *  link( [m], connection(p-[p], is(v),       in(_G1600)) ),
- *  link( [m], connection(s-[s], house(n),    is(v)) ),
- *  link( [m], connection(d-[s], the(_G1556), house(n)) ),
- * \
- *  link( [m], connection(w-[d], 'left-wall'(_G1533), house(n)) ),
- *  link( [],  connection(rw-[], 'left-wall'(_G1513), 'right-wall'(_G1511)) )
- * ]
+ * This function raises error(resource_error(connector_table), _), when a connector label can't be given a label id in the compact format
+**/
+
+static int raise_connector_table_full() {
+
+term_t exception = PL_new_term_ref();
+
+  PL_unify_term(exception,
+                PL_FUNCTOR, PL_new_functor(PL_new_atom("error"), 2),
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("resource_error"), 1),
+                    PL_CHARS, "connector_table",
+                  PL_VARIABLE);
+  return PL_raise_exception(exception);
+}
+
+
+/**
+ * @name static int linkage_to_compact(Linkage linkage, int fields, term_t compact_term)
+ *
+ * @description
+ * This function unifies compact_term with the compact representation of a linkage: compact(Words, Links)
+ * Words is a words/N compound, N being the number of words in the linkage (walls included). Its arguments are the words as Prolog strings, as output by the lgp library (eg: "house.n"), so that each word is only output once per linkage
+ * Links is a list of l(Left_index, Right_index, Label_id, Domain_mask) terms, one per link, in the order of the links in the linkage:
+ * Left_index and Right_index are the positions of the linked words in Words (0-based)
+ * Label_id is the integer identifying the connector label in the table of compiled connectors (see connector_label/2 to get the label back). error(resource_error(connector_table), _) is raised if the label can't be recorded in this table (table full, or subscript longer than MAX_CONNECTOR_SUBSCRIPT characters)
+ * Domain_mask is an integer with bit (D-'a') set for each domain D of the link
+ * fields is a mask of OUTPUT_FIELD_xxx bits: Words, Label_id and Domain_mask are left unbound when their bit is not set
+**/
+
+static int linkage_to_compact(Linkage linkage, int fields, term_t compact_term) {
+
+int                num_words;
+int                links_number;
+int                link;
+int                word_index;
+int                domain_index;
+int                domain_mask;
+char               **domain_name; /* Domain name array */
+char               *label;
+compiled_connector *compiled;
+term_t             words_arguments; /* Array of terms for the arguments of words/N */
+term_t             words = PL_new_term_ref();
+term_t             new_link_element = PL_new_term_ref();
+term_t             constructed_links_list = PL_new_term_ref();
+term_t             link_argument = PL_new_term_ref(); /* Argument of the current l/4 term */
+Dictionary         dict;
+
+  num_words = linkage_get_num_words(linkage);
+  links_number = linkage_get_num_links(linkage);
+  dict = linkage_get_sentence(linkage)->dict; /* See linkage_to_compound() concerning this direct access */
+
+  if (fields & OUTPUT_FIELD_WORDS) {
+    words_arguments = PL_new_term_refs(num_words);
+    for (word_index=0; word_index<num_words; word_index++) {
+      if ((word_index == 0) && dict->left_wall_defined)
+        PL_put_string_chars(words_arguments+word_index, LEFT_WALL_DISPLAY);
+      else if ((word_index == num_words-1) && dict->right_wall_defined)
+        PL_put_string_chars(words_arguments+word_index, RIGHT_WALL_DISPLAY);
+      else
+        PL_put_string_chars(words_arguments+word_index, linkage_get_word(linkage, word_index));
+    }
+    if (!PL_cons_functor_v(words, PL_new_functor(PL_new_atom("words"), num_words), words_arguments)) PL_fail;
+  } /* Otherwise, words is left unbound */
+
+  PL_put_nil(constructed_links_list);
+  for (link=links_number-1; link>=0; link--) { /* The list is built from its tail */
+    if (linkage_get_link_lword(linkage, link) == -1) continue;
+    PL_put_variable(new_link_element);
+    if (!PL_unify_term(new_link_element,
+                       PL_FUNCTOR, FUNCTOR_l4,
+                       PL_INT, linkage_get_link_lword(linkage, link),
+                       PL_INT, linkage_get_link_rword(linkage, link),
+                       PL_VARIABLE,
+                       PL_VARIABLE)) PL_fail; /* Label_id and Domain_mask are filled below if they are requested by the fields/1 output option */
+    if (fields & OUTPUT_FIELD_LABELS) {
+      label = linkage_get_link_label(linkage, link);
+      compiled = get_compiled_connector(label);
+      if (compiled == NULL) return raise_connector_table_full();
+      PL_get_arg(3, new_link_element, link_argument);
+      if (!PL_unify_integer(link_argument, (int)(compiled - compiled_connector_table))) PL_fail; /* The label id is its slot in the table */
+    }
+    if (fields & OUTPUT_FIELD_DOMAINS) {
+      domain_mask = 0;
+      domain_name = linkage_get_link_domain_names(linkage, link);
+      for (domain_index=0; domain_index<linkage_get_link_num_domains(linkage, link); ++domain_index) {
+        if (islower(domain_name[domain_index][0])) domain_mask |= 1 << (domain_name[domain_index][0]-'a');
+      }
+      PL_get_arg(4, new_link_element, link_argument);
+      if (!PL_unify_integer(link_argument, domain_mask)) PL_fail;
+    }
+    PL_cons_list(constructed_links_list, new_link_element, constructed_links_list);
+  }
+
+  return PL_unify_term(compact_term,
+                       PL_FUNCTOR, FUNCTOR_compact2,
+                       PL_TERM, words,
+                       PL_TERM, constructed_links_list);
+}
+
+
+/**
+ * @name linkage_to_compound(Linkage linkage, linkage_output_format *format, term_t links_list)
+ *
+ * @description
+ * This function creates a Prolog compund term gathering all the information that could be got from the linkage object (domains, links, names of words, type of words...)
+ * When exiting, all the information is contained inside the Prolog term links_list, that is to say that NO MEMORY is used by temporary objects after returning from this function. It's up to the Prolog engine to take care (detecting obsolescence, and releasing unused memory) of the links_list term and all the nested terms it includes.
+ * Here is a summary of what is sent back as a the links_list Prolog term:
+ * Sentence: The house is in the middle of my garden
+ * A call to linkage_print_links_and_domains(linkage) would return the following C-string:
+ *       LEFT-WALL      RW      <-RW->  RW        RIGHT-WALL
+ * (m)   LEFT-WALL      Wd      <-Wd->  Wd        house.n
+ * (m)   the            D       <-Ds->  Ds        house.n
+ * (m)   house.n        Ss      <-Ss->  Ss        is.v
+ * (m)   is.v           Pp      <-Pp->  Pp        in
+ * (m)   in             J       <-Js->  Js        middle.n
+ * (m)   the            D       <-Ds->  Ds        middle.n
+ * (m)   middle.n       M       <-Mp->  Mp        of
+ * (m)   of             J       <-Js->  Js        garden.n
+ * (m)   my             D       <-Ds->  Ds        garden.n
+ * And a call to linkage_to_compound(Linkage linkage, term_t links_list) will return the following term, inside links_list:
+ * [link( [m], connection(d-[s], my(_G1717),  garden(n)) ),
+ *  link( [m], connection(j-[s], of(_G1694),  garden(n)) ),
+ *  link( [m], connection(m-[p], middle(n),   of(_G1669)) ),
+ *  link( [m], connection(d-[s], the(_G1648), middle(n)) ),
+ *  link( [m], connection(j-[s], in(_G1625),  middle(n)) ),
+ *  link( [m], connection(p-[p], is(v),       in(_G1600)) ),
+ *  link( [m], connection(s-[s], house(n),    is(v)) ),
+ *  link( [m], connection(d-[s], the(_G1556), house(n)) ),
+ * \
+ *  link( [m], connection(w-[d], 'left-wall'(_G1533), house(n)) ),
+ *  link( [],  connection(rw-[], 'left-wall'(_G1513), 'right-wall'(_G1511)) )
+ * ]
  * Let's have a quick but precise look at what has been created:
  * The links_list is (and its name has been chosen for this purpose!) a Prolog list.
  * Each element corresponds to a grammar link returned by the parser (which is equivalent to a line output by linkage_print_links_and_domains.
@@ -3238,9 +4836,10 @@ char     *cs, *cd; /* String manipulation pointers */
  * Its first parameter is a description of the grammar link type. The major type is put first, followed by a - and a list of one letter atoms. Each of those letters in the list is part of the link subscript.
  * Here is one example for the link type: MXs will be coded as mx-[s], and Pg*b will be coded p-[g, _, b]. The unbound variable is the Prolog interpretation of * inside the grammar parser.
  * The second and the third parameters for connection/3 are the words bound by the link. Each word has one parameter which is a letter corresponding to the type of word (or an unbound term if the type has not been precised by the underlying grammar parser layer). Therefore, in the preceeding example, house(n) means the 'house' word, used as a name (n)
+ * Parts of this term that are not selected by the fields/1 output option (domains, words, labels) are left unbound, and the lgp library is not queried for them (see get_linkage_output_format_with_exception_handling())
 **/
 
-static int linkage_to_compound(Linkage linkage, term_t links_list) {
+static int linkage_to_compound(Linkage linkage, linkage_output_format *format, term_t links_list) {
   /* To the left of each link, print the sequence of domains it is in. */
   /* Printing a domain means printing its type                         */
   /* Takes info from pp_link_array and pp and chosen_words.            */
@@ -3261,7 +4860,9 @@ term_t     exception; /* Term to return in case of exception */
 Sentence   sent; /* Sentence associated with the linkage passed as parameter to this function */
 Dictionary dict; /* Dictionary associated with this linkage */
 int        l, r; /* Number of words on the right and on the left of the current link */
-char       *label, *llabel, *rlabel; /* Connector names */
+
+  if (format->linkage_format == LINKAGE_FORMAT_COMPACT)
+    return linkage_to_compact(linkage, format->fields, links_list);
 
   links_number = linkage_get_num_links(linkage);
   sent = linkage_get_sentence(linkage); /* Get the sentence handle index for the linkage (this way to access sent from the linkage is internal to the Language Grammar Parser code, and has nothing to do with this API) */
@@ -3273,30 +4874,39 @@ char       *label, *llabel, *rlabel; /* Connector names */
 
   for (link=0; link<links_number; link++) { /* Browse through all the links */
     if (linkage_get_link_lword(linkage, link) == -1) continue;
-    domain_name = linkage_get_link_domain_names(linkage, link);
-    PL_put_nil(constructed_domain_list);
-    for (domain_index=0; domain_index<linkage_get_link_num_domains(linkage, link); ++domain_index) {
-      PL_put_atom_chars(new_domain_element, domain_name[domain_index]);
-      PL_cons_list(constructed_domain_list, new_domain_element, constructed_domain_list);
+    if (format->fields & OUTPUT_FIELD_DOMAINS) {
+      domain_name = linkage_get_link_domain_names(linkage, link);
+      PL_put_nil(constructed_domain_list);
+      for (domain_index=0; domain_index<linkage_get_link_num_domains(linkage, link); ++domain_index) {
+        PL_put_atom_chars(new_domain_element, domain_name[domain_index]);
+        PL_cons_list(constructed_domain_list, new_domain_element, constructed_domain_list);
+      }
+    }
+    else {
+      PL_put_variable(constructed_domain_list); /* Domains not requested by the fields/1 output option */
     }
     
     l      = linkage_get_link_lword(linkage, link); /* Get the number of words on the left of this link */
     r      = linkage_get_link_rword(linkage, link); /* Get the number of words on the right of this link */
-    label  = linkage_get_link_label(linkage, link); /* Get the name of the link (connector and subscript) for this link */
-    llabel = linkage_get_link_llabel(linkage, link);
-    rlabel = linkage_get_link_rlabel(linkage, link);
 
-    if ((l == 0) && dict->left_wall_defined) {
-      left_word=LEFT_WALL_DISPLAY;
-    } else if ((l == (linkage_get_num_words(linkage)-1)) && dict->right_wall_defined) {
-      left_word=RIGHT_WALL_DISPLAY;	
-    } else {
-      left_word=linkage_get_word(linkage, l);
+    if (!(format->fields & OUTPUT_FIELD_WORDS)) {
+      PL_put_variable(right_word_term); /* Words not requested by the fields/1 output option */
+      PL_put_variable(left_word_term);
+    }
+    else {
+      if ((l == 0) && dict->left_wall_defined) {
+        left_word=LEFT_WALL_DISPLAY;
+      } else if ((l == (linkage_get_num_words(linkage)-1)) && dict->right_wall_defined) {
+        left_word=RIGHT_WALL_DISPLAY;	
+      } else {
+        left_word=linkage_get_word(linkage, l);
+      }
+      right_word=linkage_get_word(linkage, r);
     }
-    right_word=linkage_get_word(linkage, r);
 
-    if (!(word_to_term(right_word, right_word_term) &&
-          word_to_term(left_word, left_word_term))) {
+    if ((format->fields & OUTPUT_FIELD_WORDS) &&
+        !(word_to_term(right_word, r, format, right_word_term) &&
+          word_to_term(left_word, l, format, left_word_term))) {
       exception=PL_new_term_ref();
       PL_unify_term(exception,
                     PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 1),
@@ -3304,7 +4914,10 @@ char       *label, *llabel, *rlabel; /* Connector names */
       return PL_raise_exception(exception);
     }
     
-    if (!create_connector(label, connector)) {
+    if (!(format->fields & OUTPUT_FIELD_LABELS)) {
+      PL_put_variable(connector); /* Connector not requested by the fields/1 output option */
+    }
+    else if (!create_connector(linkage_get_link_label(linkage, link), format, connector)) { /* The label is the name of the link (connector and subscript) */
       exception=PL_new_term_ref();
       PL_unify_term(exception,
                     PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 1),
@@ -3340,111 +4953,219 @@ char       *label, *llabel, *rlabel; /* Connector names */
 
 
 /**
- * @name static int add_to_context_list(link_object, context)
+ * @name static pl_get_linkage_context *allocate_get_linkage_context()
  *
  * @description
- * This function adds a context objects to a context list (chained list containing context references)
- * The context_list is taken from the link_object passed as the first argument. Its payload contains a field .context_list pointing to the root of the context list
- * The new context object to add is passed as the second argument (it is a pointer on a pl_get_linkage_context structure). The new context will always be added at the root of the context list
+ * This function returns a new context structure for get_linkage_(), taken from the pool of released contexts when there is one (see release_get_linkage_context()), or NULL if the allocation failed
+ * Contexts are allocated with malloc() rather than exalloc(), because pooled contexts must not be counted as memory in use by the lgp library (see check_leak())
 **/
 
-static int add_to_context_list(link_linked_list_object *link_object, pl_get_linkage_context *context) {
+static pl_get_linkage_context *allocate_get_linkage_context() {
 
-term_t             exception;
-context_list*      old_root_context_list;
+context_list  *node;
 
-//  //@@ Breakpoint 1 Entering add_to_context_link //Lionel!!!
+  if ((node = free_get_linkage_contexts) == NULL)
+    return malloc(sizeof(pl_get_linkage_context));
+  free_get_linkage_contexts = node->next;
+  nb_free_get_linkage_contexts--;
+  return node->context_associated_to_link;
+}
 
-//  //@! "Breakpoint 2 Linkage set object is at %p", link_object //Lionel!!!
-  old_root_context_list=link_object->payload.associated_context_list;
-  //  //@! "Breakpoint 3 Root of context list is at %p", old_root_context_list //Lionel!!!
-  link_object->payload.associated_context_list = exalloc(sizeof(context_list));
-  if (link_object->payload.associated_context_list == NULL) { /* Allocation for the new context_list object failed */
-    link_object->payload.associated_context_list = old_root_context_list; /* Revert to previous root element */
-    exception=PL_new_term_ref();
-    PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "linkage_set",
-                  PL_CHARS, "not_enough_memory");
-    return PL_raise_exception(exception);
+
+/**
+ * @name static void release_get_linkage_context(pl_get_linkage_context *context)
+ *
+ * @description
+ * This procedure releases a context structure allocated by allocate_get_linkage_context(). It is kept in a pool for the next call to get_linkage_(), unless the pool already holds GET_LINKAGE_CONTEXT_POOL_SIZE contexts
+ * The context must have been removed from the context list of its linkage set before (see delete_from_context_link())
+**/
+
+static void release_get_linkage_context(pl_get_linkage_context *context) {
+
+  if (nb_free_get_linkage_contexts >= GET_LINKAGE_CONTEXT_POOL_SIZE) {
+    free(context);
+    return;
   }
-  // //@! "Breakpoint 4 New context created as root at %p", link_object->payload.associated_context_list //Lionel!!!
-  link_object->payload.associated_context_list->next = old_root_context_list; /* Relink the first item with the rest of the list */
-  link_object->payload.associated_context_list->context_associated_to_link=context; /* Make the new context element of the linkage set object point to the context item we are creating in order to redo the current Prolog predicate */
-  //  //@! "Breakpoint 5 New context has got a next=%p", link_object->payload.associated_context_list->next //Lionel!!!
-  PL_succeed;
+  context->list_node.context_associated_to_link = context;
+  context->list_node.previous = NULL;
+  context->list_node.next = free_get_linkage_contexts;
+  free_get_linkage_contexts = &context->list_node;
+  nb_free_get_linkage_contexts++;
+}
+
+
+/**
+ * @name static void empty_get_linkage_context_pool()
+ *
+ * @description
+ * This procedure frees all the context structures kept in the pool
+**/
+
+static void empty_get_linkage_context_pool() {
+
+context_list  *node;
+
+  while ((node = free_get_linkage_contexts) != NULL) {
+    free_get_linkage_contexts = node->next;
+    free(node->context_associated_to_link);
+  }
+  nb_free_get_linkage_contexts = 0;
+}
+
+
+/**
+ * @name static void add_to_context_list(link_object, context)
+ *
+ * @description
+ * This procedure adds a context objects to a context list (chained list containing context references)
+ * The context_list is taken from the link_object passed as the first argument. Its payload contains a field .context_list pointing to the root of the context list
+ * The new context object to add is passed as the second argument (it is a pointer on a pl_get_linkage_context structure). The new context will always be added at the root of the context list
+ * The node of the list is embedded in the context, so this can't fail
+**/
+
+static void add_to_context_list(link_linked_list_object *link_object, pl_get_linkage_context *context) {
+
+context_list*      node = &context->list_node;
+
+  node->context_associated_to_link = context; /* Make the new context element of the linkage set object point to the context item we are creating in order to redo the current Prolog predicate */
+  node->previous = NULL;
+  node->next = link_object->payload.associated_context_list; /* Relink the first item with the rest of the list */
+  if (node->next != NULL) node->next->previous = node;
+  link_object->payload.associated_context_list = node;
 }
 
 
 /**
- * @name static int delete_from_context_link(link_object, context) 
+ * @name static void delete_from_context_link(link_object, context) 
  *
  * @description
- * This function deletes all context objects a context list (chained list containing context references)
+ * This procedure removes a context object from a context list (chained list containing context references), in constant time
  * The context_list is taken from the link_object passed as the first argument. Its payload contains a field .context_list pointing to the root of the context list
- * The context objects that are matched with context, passed as the second argument will be deleted from the context list
+ * The context passed as the second argument must be in this list (see add_to_context_list())
 **/
 
-static int delete_from_context_link(link_linked_list_object *link_object, pl_get_linkage_context *context) {
+static void delete_from_context_link(link_linked_list_object *link_object, pl_get_linkage_context *context) {
 
-context_list*      current_context_in_context_list;
-context_list*      previous_context_in_context_list;
-context_list*      following_context_in_context_list;
-context_list*      root_context_list;
+context_list*      node = &context->list_node;
 
-//  //@@ Breakpoint 1 Entering delete_from_context_link //Lionel!!!
+  if (node->previous != NULL) /* We are not removing the root of the list */
+    node->previous->next = node->next; /* Shortcut this context in the context list */
+  else if (link_object->payload.associated_context_list == node)
+    link_object->payload.associated_context_list = node->next;
+  if (node->next != NULL)
+    node->next->previous = node->previous;
+  node->next = NULL;
+  node->previous = NULL;
+}
 
-//  //@! "Breakpoint 2 Linkage set object is at %p", link_object //Lionel!!!
-  previous_context_in_context_list=NULL;
-  root_context_list=link_object->payload.associated_context_list;
-  //  //@! "Breakpoint 3 Root of context list is at %p", root_context_list //Lionel!!!
-  current_context_in_context_list=root_context_list; /* Get the root of the context list for the linkage set */
 
-  while (current_context_in_context_list!=NULL) { /* Parse the whole context list */
-    // //@! "Breakpoint 4 In loop current_context_in_context_list=%p", current_context_in_context_list //Lionel!!!
-    // //@! "Breakpoint 5 In loop current_context_in_context_list->context_associated_to_link=%p", current_context_in_context_list->context_associated_to_link //Lionel!!!
-    if (current_context_in_context_list->context_associated_to_link == context) { /* We found a matching context in the list, we will remove it... */
-      //  //@@ Breakpoint 6 Match found. Will be deleted //Lionel!!!
-      if (previous_context_in_context_list!=NULL) { /* We are not currently processing the root of the list */
-        //	//@@ Breakpoint 7 Match found is not on the root //Lionel!!!
-        previous_context_in_context_list->next=current_context_in_context_list->next; /* Shortcut this context in the context list */
-        //	//@! "Breakpoint 7.1 %p->next has been set to %p", previous_context_in_context_list, current_context_in_context_list->next //Lionel!!!
-      }
-      else { /* This is the case when no previous_context_in_context_list has been recorded yet, which means that the element that matched was actually the root of the list */
-        //	//@@ Breakpoint 8 Match found is on the root //Lionel!!!
-        link_object->payload.associated_context_list=current_context_in_context_list->next;
-        //	//@! "Breakpoint 8.1 Root of context list has been set to %p", current_context_in_context_list->next //Lionel!!!
-      }
-      //      //@@ Breakpoint 9 freeing up memory for the context_list item //Lionel!!!
-      following_context_in_context_list=current_context_in_context_list->next; /* We do this before freeing current_context_in_context_list, of course! */
-      exfree(current_context_in_context_list, sizeof(context_list)); /* Free the context structure */
-      current_context_in_context_list=following_context_in_context_list; /* Move to the next context in the list. We don't move the previous_context_in_context_list because, given that we have deleted current_context_in_context_list, the following element in the list is still following previous_context_in_context_list */
-//      //@@ Breakpoint 10 continuing on next item in the list having deleted an item //Lionel!!!
-    }
-    else {
-      //      //@@ Breakpoint 10 continuing on next item in the list w/o deleting //Lionel!!!
-      previous_context_in_context_list=current_context_in_context_list;
-      current_context_in_context_list=current_context_in_context_list->next; /* Carry on processing on the rest of the list */
+/**
+ * @name static int get_output_fields(term_t fields_list, int *fields)
+ *
+ * @description
+ * This function converts the list of atoms given to the fields/1 output option into a mask of OUTPUT_FIELD_xxx bits, stored in *fields
+ * FALSE is returned if fields_list is not a proper list of the atoms domains, words and labels
+**/
+
+static int get_output_fields(term_t fields_list, int *fields) {
+
+term_t list = PL_new_term_ref(); /* Remaining part of the fields list */
+term_t field = PL_new_term_ref(); /* Current field */
+char   *field_name;
+
+  *fields = 0;
+  PL_put_term(list, fields_list);
+  while (PL_get_list(list, field, list)) {
+    if (!PL_get_atom_chars(field, &field_name)) return FALSE;
+    if (strcmp(field_name, "domains") == 0)
+      *fields |= OUTPUT_FIELD_DOMAINS;
+    else if (strcmp(field_name, "words") == 0)
+      *fields |= OUTPUT_FIELD_WORDS;
+    else if (strcmp(field_name, "labels") == 0)
+      *fields |= OUTPUT_FIELD_LABELS;
+    else
+      return FALSE;
+  }
+  return PL_get_nil(list);
+}
+
+
+/**
+ * @name static int get_linkage_output_format_with_exception_handling(term_t options, linkage_output_format *format)
+ *
+ * @description
+ * This function fills-in *format from the list of output options given as the options term. Options not found in the list are set to their default value (the one used by get_linkage/2)
+ * Supported options are:
+ * word_format(functor) (default) or word_format(string)
+ * connector_format(compound) (default) or connector_format(string)
+ * format(links) (default) or format(compact) (see linkage_to_compact(), word_format and connector_format are then ignored)
+ * fields(List) where List is a list of parts of the linkage compounds to build, among domains, words and labels (default is all of them). The other parts are left unbound
+ * If options is (term_t)0, all defaults are used
+ * If the options term is not a proper list of supported options, an exception is prepared and FALSE is returned. PL_fail should then be returned to Prolog in order to raise this exception
+**/
+
+static int get_linkage_output_format_with_exception_handling(term_t options, linkage_output_format *format) {
+
+term_t exception;
+term_t list = PL_new_term_ref(); /* Remaining part of the options list */
+term_t option = PL_new_term_ref(); /* Current option */
+term_t value = PL_new_term_ref(); /* Argument of the current option */
+char   *value_name;
+
+  format->word_format = WORD_FORMAT_FUNCTOR;
+  format->connector_format = CONNECTOR_FORMAT_COMPOUND;
+  format->linkage_format = LINKAGE_FORMAT_LINKS;
+  format->fields = OUTPUT_FIELDS_ALL;
+  if (options == (term_t)0) PL_succeed;
+
+  PL_put_term(list, options);
+  while (PL_get_list(list, option, list)) {
+    if (PL_is_functor(option, FUNCTOR_fields1)) {
+      PL_get_arg(1, option, value);
+      if (!get_output_fields(value, &format->fields)) break;
+      continue;
     }
+    if (!PL_get_arg(1, option, value) || !PL_get_atom_chars(value, &value_name)) break; /* Not an option of the form name(value) */
+    if (PL_is_functor(option, FUNCTOR_word_format1) && strcmp(value_name, "functor") == 0)
+      format->word_format = WORD_FORMAT_FUNCTOR;
+    else if (PL_is_functor(option, FUNCTOR_word_format1) && strcmp(value_name, "string") == 0)
+      format->word_format = WORD_FORMAT_STRING;
+    else if (PL_is_functor(option, FUNCTOR_connector_format1) && strcmp(value_name, "compound") == 0)
+      format->connector_format = CONNECTOR_FORMAT_COMPOUND;
+    else if (PL_is_functor(option, FUNCTOR_connector_format1) && strcmp(value_name, "string") == 0)
+      format->connector_format = CONNECTOR_FORMAT_STRING;
+    else if (PL_is_functor(option, FUNCTOR_format1) && strcmp(value_name, "links") == 0)
+      format->linkage_format = LINKAGE_FORMAT_LINKS;
+    else if (PL_is_functor(option, FUNCTOR_format1) && strcmp(value_name, "compact") == 0)
+      format->linkage_format = LINKAGE_FORMAT_COMPACT;
+    else
+      break; /* Unknown option */
   }
-  //  //@! "Breakpoint 11 Root of context list is now %p", link_object->payload.associated_context_list //Lionel!!!
-  PL_succeed;
+  if (PL_get_nil(list)) PL_succeed; /* The whole list has been processed */
+
+  exception=PL_new_term_ref();
+  PL_unify_term(exception,
+                PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                PL_CHARS, "output_options",
+                PL_CHARS, "bad_option");
+  return PL_raise_exception(exception);
 }
 
 
 /**
- * @name pl_get_linkage
- * @prologname get_linkage/2
+ * @name get_linkage_(term_t linkage_set_handle, term_t t_options, term_t t_result, control_t handle)
  *
  * @description
+ * This is the common non-deterministic implementation of get_linkage/2 and get_linkage/3 (see pl_get_linkage and pl_get_linkage_with_options below). t_options is (term_t)0 for get_linkage/2
  * This predicate parses a sentence, according to a dictionary and to parse options
  * Note: this predicate manipulates the linkage_set objects, which also involves that it works with its associated sentence and parse options objects
  * While this predicate will be valid (from the PL_FIRST_CALL to PL_CUTTED or a failure to PL_REDO), a context variable will be created to memorise the status of the last call of the predicate. We don't need to make sure that references to the parse options and sentence objects are valid (objects haven't been deleted in the meantime), because the creation of linkage set objects already handle this via the reference counts
 **/
 
-foreign_t pl_get_linkage(term_t linkage_set_handle,
-                         term_t t_result,
-                         control_t handle) {
+static foreign_t get_linkage_(term_t linkage_set_handle,
+                              term_t t_options,
+                              term_t t_result,
+                              control_t handle) {
 
 pl_get_linkage_context        *context;
 
@@ -3482,7 +5203,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     }
 
     
-    context=exalloc(sizeof(pl_get_linkage_context)); /* Allocate the context structure */
+    context=allocate_get_linkage_context(); /* Allocate the context structure */
     if (context == NULL) { /* Check if memory has been successfully allocated */
       exception=PL_new_term_ref();
       PL_unify_term(exception,
@@ -3493,11 +5214,16 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     }
     context->link_handle_index = link_handle_index;
     context->last_handled_linkage = 0;
+    if (!get_linkage_output_format_with_exception_handling(t_options, &context->format)) {
+      release_get_linkage_context(context); /* Free the context structure */
+      PL_fail; /* Raise the exception prepared by get_linkage_output_format_with_exception_handling */
+    }
+    restrict_output_format_to_linkage_set(link_object, &context->format);
 
-    linkage = linkage_create(0, sent_object->payload.sentence, opts_object->payload);
-    if (!linkage_to_compound(linkage, t_result)) {
+    linkage = create_linkage_from_set(link_object, 0);
+    if (!linkage_to_compound(linkage, &context->format, t_result)) {
       linkage_delete(linkage);
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
       exception=PL_new_term_ref();
       PL_unify_term(exception,
                     PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
@@ -3508,10 +5234,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     else {
       linkage_delete(linkage);
 
-      if (!add_to_context_list(link_object, context)) { /* If this fails, there is an exception to raise, so PL_fail will pass the exception to Prolog */
-        exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
-        PL_fail;
-      }
+      add_to_context_list(link_object, context);
       // //@! "Breakpoint 2 Setting up retry structure with context %p", context //Lionel!!!
       
       PL_retry_address(context); /* Allow redo, and precise the address of the context structure */
@@ -3533,7 +5256,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     link_handle_index = context->link_handle_index; /* This part retrieves the context variables and stores them inside local stack variables */
  
     if (link_handle_index == -1) { /* No linkage set object is referenced by context->link_handle_index... this must come from the fact that the linkage set has been deleted, and our context was updated accordingly */
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
       exception=PL_new_term_ref();
       PL_unify_term(exception,
                     PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
@@ -3560,16 +5283,16 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
       // //@! "going to call delete_from_context_link(%p, %p)", link_object, context  //Lionel!!!
       delete_from_context_link(link_object, context); /* Delete all references to our context from the linkage set object we used to reference, given that we are going to destroy the context item itself */
       // //@! "going to call exfree on %p", context  //Lionel!!!
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
       PL_fail;
     }
     
     
-    linkage = linkage_create(context->last_handled_linkage, sent_object->payload.sentence, opts_object->payload);
-    if (!linkage_to_compound(linkage, t_result)) {
+    linkage = create_linkage_from_set(link_object, context->last_handled_linkage);
+    if (!linkage_to_compound(linkage, &context->format, t_result)) {
       linkage_delete(linkage);
       delete_from_context_link(link_object, context); /* Delete all references to our context from the linkage set object we used to reference, given that we are going to destroy the context item itself */
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
       PL_fail;
     }
     else {
@@ -3593,7 +5316,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     link_handle_index = context->link_handle_index; /* This part retrieves the context variables and stores them inside local stack variables */
  
     if (link_handle_index == -1) { /* No linkage set object is referenced by context->link_handle_index... this must come from the fact that the linkage set has been deleted, and our context was updated accordingly */
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
       exception=PL_new_term_ref();
       PL_unify_term(exception,
                     PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
@@ -3610,7 +5333,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
     //    //@@ Breakpoint 7 Going to call delete_from_context_link //Lionel!!!
     delete_from_context_link(link_object, context); /* Delete all references to our context from the linkage set object we used to reference, given that we are going to destroy the context item itself */
     //    //@@ Breakpoint 8 Going to call exfree //Lionel!!!
-    exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+    release_get_linkage_context(context); /* Free the context structure */
     PL_succeed;
     break;
   }
@@ -3627,7 +5350,7 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
           delete_from_context_link(link_object, context); /* Delete all references to our context from the linkage set object we used to reference, given that we are going to destroy the context item itself */
         }
       }
-      exfree(context, sizeof(pl_get_linkage_context)); /* Free the context structure */
+      release_get_linkage_context(context); /* Free the context structure */
     }
   }
   PL_fail;
@@ -3635,196 +5358,2054 @@ opts_linked_list_object       *opts_object; /* Linked object corresponding to th
 
 
 /**
- * @name main(int argc, char **argv)
+ * @name pl_get_linkage(term_t linkage_set_handle, term_t t_result, control_t handle)
+ * @prologname get_linkage/2
  *
  * @description
- * This main function is there to give a WinMain@16 label to CygWin. It is not used during the DLL normal use
+ * Non-deterministic predicate returning each linkage of a linkage set in turn, using the default output format (see get_linkage_() above)
 **/
 
-int main(int argc, char **argv) {
-  return 0;
+foreign_t pl_get_linkage(term_t linkage_set_handle, term_t t_result, control_t handle) {
+  return get_linkage_(linkage_set_handle, (term_t)0, t_result, handle);
 }
 
 
-#if (defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32))
 /**
- * @name lgp_init_dll(HANDLE h, DWORD reason, void *foo)
+ * @name pl_get_linkage_with_options(term_t linkage_set_handle, term_t t_options, term_t t_result, control_t handle)
+ * @prologname get_linkage/3
  *
  * @description
- * This function is the entry point of the DLL. It is started when the DLL is loaded in memory and does... nothing!
+ * Same as get_linkage/2, but the shape of the linkage compounds is selected by the list of output options t_options (see get_linkage_output_format_with_exception_handling())
+ * The options are only read at the first call, each redo reuses them
 **/
 
-int WINAPI lgp_init_dll(HANDLE h, DWORD reason, void *foo) {
-  return 1;
+foreign_t pl_get_linkage_with_options(term_t linkage_set_handle, term_t t_options, term_t t_result, control_t handle) {
+  return get_linkage_(linkage_set_handle, t_options, t_result, handle);
 }
-#endif
 
 
 /**
- * @name install_lgp()
+ * @name pl_get_linkages(term_t linkage_set_handle, term_t t_from, term_t t_count, term_t t_options, term_t t_result_list)
+ * @prologname get_linkages/5
  *
  * @description
- * This is the initialisation routine for this foreign language library
- * This function has to be called by load_foreign_library/2 from the Prolog side in order to register the predicates implemented here as C code
+ * This predicate extracts at most t_count linkages from a linkage set, starting with the linkage number t_from (0-based), and unifies t_result_list with the list of their compounds (in the same format as get_linkage/3 with the output options t_options), in ascending order
+ * Contrary to get_linkage/2, all linkages are converted in one single call, without going through a foreign context and a redo for each of them
+ * The linkages are still extracted one after the other: linkage_create() post-processes them on state shared by the whole sentence and allocates through the global memory accounting of the lgp library, so two extractions can't run at the same time
+ * The range is truncated to the linkages actually available in the linkage set, so the list can be shorter than t_count (or even empty)
 **/
 
-install_t install_lgp() {
-
-term_t exception; /* Handle for a possible exception */
-
-  PL_register_foreign("create_dictionary", 5, pl_create_dictionary, 0);
-  PL_register_foreign("delete_dictionary", 1, pl_delete_dictionary, 0);
-  PL_register_foreign("delete_all_dictionaries", 0, pl_delete_all_dictionaries, 0);
-  PL_register_foreign("get_nb_dictionaries", 1, pl_get_nb_dictionaries, 0);
-  PL_register_foreign("get_handles_nb_references_dictionaries", 2, pl_get_handles_nb_references_dictionaries, 0);
-
-  PL_register_foreign("create_parse_options_", 1, pl_create_parse_options, 0);
-  PL_register_foreign("delete_parse_options", 1, pl_delete_parse_options, 0);
-  PL_register_foreign("delete_all_parse_options", 0, pl_delete_all_parse_options, 0);
-  PL_register_foreign("get_nb_parse_options", 1, pl_get_nb_parse_options, 0);
-  PL_register_foreign("get_handles_nb_references_parse_options", 2, pl_get_handles_nb_references_parse_options, 0);
-
-  PL_register_foreign("create_linkage_set", 3, pl_create_linkage_set, 0);
-  PL_register_foreign("delete_linkage_set", 1, pl_delete_linkage_set, 0);
-  PL_register_foreign("delete_all_linkage_sets", 0, pl_delete_all_linkage_sets, 0);
-  PL_register_foreign("get_nb_linkage_sets", 1, pl_get_nb_linkage_sets, 0);
-  PL_register_foreign("get_handles_nb_references_linkage_sets", 2, pl_get_handles_nb_references_linkage_sets, 0);
-
-  PL_register_foreign("get_num_linkages", 2, pl_get_num_linkages, 0);
-  PL_register_foreign("get_parameters_for_linkage_set", 2, pl_get_parameters_for_linkage_set, 0);
-
-  PL_register_foreign("create_sentence", 3, pl_create_sentence, 0);
-  PL_register_foreign("delete_sentence", 1, pl_delete_sentence, 0);
-  PL_register_foreign("delete_all_sentences", 0, pl_delete_all_sentences, 0);
-  PL_register_foreign("get_nb_sentences", 1, pl_get_nb_sentences, 0);
-  PL_register_foreign("get_handles_nb_references_sentences", 2, pl_get_handles_nb_references_sentences, 0);
-
-  PL_register_foreign("po_set_linkage_limit_", 2, pl_po_set_linkage_limit, 0);
-  PL_register_foreign("po_get_linkage_limit_", 2, pl_po_get_linkage_limit, 0);
-  PL_register_foreign("po_set_disjunct_cost_", 2, pl_po_set_disjunct_cost, 0);
-  PL_register_foreign("po_get_disjunct_cost_", 2, pl_po_get_disjunct_cost, 0);
-  PL_register_foreign("po_set_min_null_count_", 2, pl_po_set_min_null_count, 0);
-  PL_register_foreign("po_get_min_null_count_", 2, pl_po_get_min_null_count, 0);
-  PL_register_foreign("po_set_max_null_count_", 2, pl_po_set_max_null_count, 0);
-  PL_register_foreign("po_get_max_null_count_", 2, pl_po_get_max_null_count, 0);
-  PL_register_foreign("po_set_null_block_", 2, pl_po_set_null_block, 0);
-  PL_register_foreign("po_get_null_block_", 2, pl_po_get_null_block, 0);
-  PL_register_foreign("po_set_islands_ok_", 2, pl_po_set_islands_ok, 0);
-  PL_register_foreign("po_get_islands_ok_", 2, pl_po_get_islands_ok, 0);
-  PL_register_foreign("po_set_short_length_", 2, pl_po_set_short_length, 0);
-  PL_register_foreign("po_get_short_length_", 2, pl_po_get_short_length, 0);
-  PL_register_foreign("po_set_all_short_connectors_", 2, pl_po_set_all_short_connectors, 0);
-  PL_register_foreign("po_get_all_short_connectors_", 2, pl_po_get_all_short_connectors, 0);
-  PL_register_foreign("po_set_max_parse_time_", 2, pl_po_set_max_parse_time, 0);
-  PL_register_foreign("po_get_max_parse_time_", 2, pl_po_get_max_parse_time, 0);
-  PL_register_foreign("po_set_max_memory_", 2, pl_po_set_max_memory, 0);
-  PL_register_foreign("po_get_max_memory_", 2, pl_po_get_max_memory, 0);
-  PL_register_foreign("po_set_max_sentence_length_", 2, pl_po_set_max_sentence_length, 0);
-  PL_register_foreign("po_get_max_sentence_length_", 2, pl_po_get_max_sentence_length, 0);
-  PL_register_foreign("po_set_batch_mode_", 2, pl_po_set_batch_mode, 0);
-  PL_register_foreign("po_get_batch_mode_", 2, pl_po_get_batch_mode, 0);
-  PL_register_foreign("po_set_panic_mode_", 2, pl_po_set_panic_mode, 0);
-  PL_register_foreign("po_get_panic_mode_", 2, pl_po_get_panic_mode, 0);
-  PL_register_foreign("po_set_allow_null_", 2, pl_po_set_allow_null, 0);
-  PL_register_foreign("po_get_allow_null_", 2, pl_po_get_allow_null, 0);
-
-  PL_register_foreign("get_max_sentence", 1, pl_get_max_sentence, 0);
-  PL_register_foreign("enable_panic_on_parse_options", 1, pl_enable_panic_on_parse_options, 0);
-  PL_register_foreign("disable_panic_on_parse_options", 1, pl_disable_panic_on_parse_options, 0);
-
-  PL_register_foreign("get_linkage", 2, pl_get_linkage, PL_FA_NONDETERMINISTIC);
+foreign_t pl_get_linkages(term_t linkage_set_handle, term_t t_from, term_t t_count, term_t t_options, term_t t_result_list) {
 
-  FUNCTOR_dictionary1 = PL_new_functor(PL_new_atom("$dictionary"), 1); /* Create a '$dictionary'/1 functor for dictionary table handling */
-  FUNCTOR_options1 = PL_new_functor(PL_new_atom("$options"), 1); /* Create a '$options'/1 functor for parse options table handling */
-  FUNCTOR_linkageset1 = PL_new_functor(PL_new_atom("$linkageset"), 1); /* Create a '$linkage'/1 functor for parse options table handling */
-  FUNCTOR_sentence1 = PL_new_functor(PL_new_atom("$sentence"), 1); /* Create a '$sentence'/1 functor for parse options table handling */
+term_t                  exception;
+term_t                  constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t                  new_linkage_element = PL_new_term_ref(); /* Term used to store one linkage compound before adding it to the list */
+unsigned int            link_handle_index;
+link_linked_list_object *link_object; /* Linkage set object on which we work here */
+Linkage                 linkage;
+int                     from, count, last; /* Range of linkages to extract */
+int                     linkage_index;
+linkage_output_format   format; /* Shape of the linkage compounds to output */
 
-  FUNCTOR_list2 = PL_new_functor(PL_new_atom("."), 2); /* Create the list functor (./2) */
-  FUNCTOR_equals2 = PL_new_functor(PL_new_atom("="), 2); /* Create the =/2 functor */
-  FUNCTOR_link2 = PL_new_functor(PL_new_atom("link"), 2); /* Create the link/2 functor */
-  FUNCTOR_hyphen2 = PL_new_functor(PL_new_atom("-"), 2); /* Create the -/2 functor */
-  FUNCTOR_connection3 = PL_new_functor(PL_new_atom("connection"), 3); /* Create the connection/3 functor */
 
-/* We test that root_dict_list is NULL here (it has been initialised with this value in its declaration above) */
-  if (root_dict_list != NULL) {
+  if (!get_index_from_handle(FUNCTOR_linkageset1, linkage_set_handle, &link_handle_index)) {
     exception=PL_new_term_ref();
     PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "dictionary",
-                  PL_CHARS, "list_corrupted");
-    PL_raise_exception(exception);
-    return;
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
   }
-
-  root_dict_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of dictionaries with a generic object type */
-  if (root_dict_list == NULL) { /* Allocation failed */
+  if (!PL_get_integer(t_from, &from) || !PL_get_integer(t_count, &count) || from < 0 || count < 0) {
     exception=PL_new_term_ref();
     PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "dictionary",
-                  PL_CHARS, "not_enough_memory");
-    PL_raise_exception(exception);
-    return;
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_range");
+    return PL_raise_exception(exception);
   }
-  root_dict_list->next=NULL; /* No first element attached to the root: the list is empty */
-  root_dict_list->nb_jumped_index=0; /* No jumped free space */
-  root_dict_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
-
-  root_opts_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of parse options with a generic object type */
-  if (root_opts_list == NULL) { /* Allocation failed */
-    exception=PL_new_term_ref();
-    PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "parse_options",
-                  PL_CHARS, "not_enough_memory");
-    PL_raise_exception(exception);
-    return;
+  if (!get_linkage_output_format_with_exception_handling(t_options, &format)) {
+    PL_fail; /* Raise the exception prepared by get_linkage_output_format_with_exception_handling */
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("linkage_set", NULL,
+                                                                            root_link_list, link_handle_index, (generic_linked_list_object **)&link_object)) {
+    PL_fail; /* get_object_from_handle_index_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
   }
-  root_opts_list->next=NULL; /* No first element attached to the root: the list is empty */
-  root_opts_list->nb_jumped_index=0; /* No jumped free space */
-  root_opts_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
 
-  root_link_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of linkage sets with a generic object type */
-  if (root_link_list == NULL) { /* Allocation failed */
-    exception=PL_new_term_ref();
-    PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "linkage_set",
-                  PL_CHARS, "not_enough_memory");
-    PL_raise_exception(exception);
-    return;
+  restrict_output_format_to_linkage_set(link_object, &format);
+  last = link_object->payload.num_linkages; /* Index following the last linkage to extract */
+  if (count < last - from) last = from + count;
+
+  PL_put_nil(constructed_list); /* The list is built from its tail, so linkages are extracted from the last one to the first one */
+  for (linkage_index = last-1; linkage_index >= from; linkage_index--) {
+    linkage = create_linkage_from_set(link_object, linkage_index);
+    if (!linkage_to_compound(linkage, &format, new_linkage_element)) {
+      linkage_delete(linkage);
+      exception=PL_new_term_ref();
+      PL_unify_term(exception,
+                    PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                    PL_CHARS, "linkage_to_compound",
+                    PL_CHARS, "failed");
+      return PL_raise_exception(exception);
+    }
+    linkage_delete(linkage);
+    PL_cons_list(constructed_list, new_linkage_element, constructed_list);
   }
-  root_link_list->next=NULL; /* No first element attached to the root: the list is empty */
-  root_link_list->nb_jumped_index=0; /* No jumped free space */
-  root_link_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
 
-  root_sent_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of sentences with a generic object type */
-  if (root_sent_list == NULL) { /* Allocation failed */
-    exception=PL_new_term_ref();
-    PL_unify_term(exception,
-                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
-                  PL_CHARS, "sentence",
-                  PL_CHARS, "not_enough_memory");
-    PL_raise_exception(exception);
-    return;
+  return PL_unify(t_result_list, constructed_list);
+}
+
+
+/* The following structure holds the cost of one linkage of a linkage set, as computed by the lgp library during post-processing (see pl_get_best_linkages()) */
+typedef struct {
+  int                      disjunct_cost;
+  int                      link_cost; /* Total length of the links */
+  int                      linkage_index; /* Index of the linkage in the linkage set */
+} linkage_cost;
+
+
+/**
+ * @name static int compare_linkage_costs(const void *a, const void *b)
+ *
+ * @description
+ * Ordering on linkage_cost structures (compatible with qsort()): disjunct cost first, then link cost, then index in the linkage set (so that linkages with equal costs keep the order of get_linkage/2)
+**/
+
+static int compare_linkage_costs(const void *a, const void *b) {
+
+const linkage_cost *cost_a = a;
+const linkage_cost *cost_b = b;
+
+  if (cost_a->disjunct_cost != cost_b->disjunct_cost) return cost_a->disjunct_cost - cost_b->disjunct_cost;
+  if (cost_a->link_cost != cost_b->link_cost) return cost_a->link_cost - cost_b->link_cost;
+  return cost_a->linkage_index - cost_b->linkage_index;
+}
+
+
+/**
+ * @name static void sift_down_linkage_cost_heap(linkage_cost *heap, int heap_size, int position)
+ *
+ * @description
+ * Restores the max-heap property (the most expensive linkage at the top) of heap, below position
+**/
+
+static void sift_down_linkage_cost_heap(linkage_cost *heap, int heap_size, int position) {
+
+int          child;
+linkage_cost temp;
+
+  while ((child = 2*position+1) < heap_size) {
+    if (child+1 < heap_size && compare_linkage_costs(&heap[child+1], &heap[child]) > 0) child++; /* Pick the most expensive child */
+    if (compare_linkage_costs(&heap[child], &heap[position]) <= 0) break;
+    temp = heap[child];
+    heap[child] = heap[position];
+    heap[position] = temp;
+    position = child;
   }
-  root_sent_list->next=NULL; /* No first element attached to the root: the list is empty */
-  root_sent_list->nb_jumped_index=0; /* No jumped free space */
-  root_sent_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
 }
 
 
 /**
- * @name uninstall_lgp()
+ * @name pl_get_best_linkages(term_t linkage_set_handle, term_t t_k, term_t t_options, term_t t_result_list)
+ * @prologname get_best_linkages/4
  *
  * @description
- * This is the uninstallation routine for this foreign language library
- * This function is be called by unload_foreign_library/2 from the Prolog side in order to free the memory used by the DLL
+ * This predicate unifies t_result_list with the list of the (at most) t_k cheapest linkages of a linkage set, the cheapest first, in the format selected by the output options t_options (see get_linkage_output_format_with_exception_handling())
+ * The costs (disjunct cost and total link length, the unused word cost being the same for all the linkages of a sentence) are the ones computed by the lgp library during post-processing, so they are read for all linkages without creating them
+ * A bounded max-heap of t_k entries keeps the best linkages while browsing the linkage set, and only these winners are then created and converted to Prolog terms
+**/
+
+foreign_t pl_get_best_linkages(term_t linkage_set_handle, term_t t_k, term_t t_options, term_t t_result_list) {
+
+term_t                  exception;
+term_t                  constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t                  new_linkage_element = PL_new_term_ref(); /* Term used to store one linkage compound before adding it to the list */
+unsigned int            link_handle_index;
+link_linked_list_object *link_object; /* Linkage set object on which we work here */
+Sentence                sent;
+Linkage                 linkage;
+linkage_output_format   format; /* Shape of the linkage compounds to output */
+linkage_cost            *heap; /* Bounded max-heap of the best linkages found so far */
+linkage_cost            candidate;
+int                     k, heap_size, num_linkages;
+int                     linkage_index;
+
+
+  if (!get_index_from_handle(FUNCTOR_linkageset1, linkage_set_handle, &link_handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!PL_get_integer(t_k, &k) || k < 0) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "bad_range");
+    return PL_raise_exception(exception);
+  }
+  if (!get_linkage_output_format_with_exception_handling(t_options, &format)) {
+    PL_fail; /* Raise the exception prepared by get_linkage_output_format_with_exception_handling */
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("linkage_set", NULL,
+                                                                            root_link_list, link_handle_index, (generic_linked_list_object **)&link_object)) {
+    PL_fail; /* get_object_from_handle_index_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
+  }
+
+  restrict_output_format_to_linkage_set(link_object, &format);
+  sent = link_object->payload.sentence;
+  num_linkages = link_object->payload.num_linkages;
+  if (k > num_linkages) k = num_linkages;
+  PL_put_nil(constructed_list);
+  if (k == 0) return PL_unify(t_result_list, constructed_list);
+
+  heap = exalloc(k * sizeof(linkage_cost));
+  if (heap == NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "linkage_set",
+		  PL_CHARS, "not_enough_memory");
+    return PL_raise_exception(exception);
+  }
+
+  heap_size = 0;
+  for (linkage_index = 0; linkage_index < num_linkages; linkage_index++) {
+    candidate.disjunct_cost = sentence_disjunct_cost(sent, linkage_index);
+    candidate.link_cost = sentence_link_cost(sent, linkage_index);
+    candidate.linkage_index = linkage_index;
+    if (heap_size < k) { /* The heap is not full yet, insert the candidate (sift up) */
+      int position = heap_size++;
+      while (position > 0 && compare_linkage_costs(&heap[(position-1)/2], &candidate) < 0) {
+        heap[position] = heap[(position-1)/2];
+        position = (position-1)/2;
+      }
+      heap[position] = candidate;
+    }
+    else if (compare_linkage_costs(&candidate, &heap[0]) < 0) { /* Cheaper than the most expensive of the best linkages so far, replace it */
+      heap[0] = candidate;
+      sift_down_linkage_cost_heap(heap, heap_size, 0);
+    }
+  }
+
+  qsort(heap, heap_size, sizeof(linkage_cost), compare_linkage_costs); /* Order the winners, the cheapest first */
+
+  for (linkage_index = heap_size-1; linkage_index >= 0; linkage_index--) { /* The list is built from its tail */
+    linkage = create_linkage_from_set(link_object, heap[linkage_index].linkage_index);
+    if (!linkage_to_compound(linkage, &format, new_linkage_element)) {
+      linkage_delete(linkage);
+      exfree(heap, k * sizeof(linkage_cost));
+      exception=PL_new_term_ref();
+      PL_unify_term(exception,
+                    PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                    PL_CHARS, "linkage_to_compound",
+                    PL_CHARS, "failed");
+      return PL_raise_exception(exception);
+    }
+    linkage_delete(linkage);
+    PL_cons_list(constructed_list, new_linkage_element, constructed_list);
+  }
+  exfree(heap, k * sizeof(linkage_cost));
+
+  return PL_unify(t_result_list, constructed_list);
+}
+
+
+/**
+ * @name foreign_t pl_begin_parse_session(term_t t_parent_session, term_t t_session)
+ * @prologname begin_parse_session_/2
+ *
+ * @description
+ * This predicate starts a new parse session for the calling thread: all the objects created by this thread until end_parse_session_/2 is called belong to it
+ * t_parent_session is unified with the session that was current (0 if none), which must be given back to end_parse_session_/2, and t_session with the new session
+**/
+
+foreign_t pl_begin_parse_session(term_t t_parent_session, term_t t_session) {
+
+unsigned int parent_session = current_parse_session;
+
+  if (!PL_unify_integer(t_parent_session, parent_session) || !PL_unify_integer(t_session, last_parse_session+1)) PL_fail;
+  current_parse_session = ++last_parse_session;
+  PL_succeed;
+}
+
+
+/**
+ * @name foreign_t pl_end_parse_session(term_t t_session, term_t t_parent_session)
+ * @prologname end_parse_session_/2
+ *
+ * @description
+ * This predicate ends a parse session started by begin_parse_session_/2: all the linkage sets, sentences, parse options and dictionaries created in the session are deleted (in this order, so that references are released first), each list being scanned only once
+ * The session of t_parent_session becomes the current one again
+**/
+
+foreign_t pl_end_parse_session(term_t t_session, term_t t_parent_session) {
+
+term_t exception; /* Handle for a possible exception */
+int    result;
+int    session, parent_session;
+
+  if (!PL_get_integer(t_session, &session) || !PL_get_integer(t_parent_session, &parent_session) || session <= 0 || parent_session < 0) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "session",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  delete_session_objects_in_chained_list(root_link_list, session, parent_session, (void (*)(generic_linked_list_object *))delete_linkage_set_object_payload);
+  delete_session_objects_in_chained_list(root_sent_list, session, parent_session, (void (*)(generic_linked_list_object *))delete_sentence_object_payload);
+  delete_session_objects_in_chained_list(root_opts_list, session, parent_session, (void (*)(generic_linked_list_object *))delete_parse_options_object_payload);
+  delete_session_objects_in_chained_list(root_dict_list, session, parent_session, (void (*)(generic_linked_list_object *))delete_dictionary_object_payload);
+  current_parse_session = parent_session;
+  check_leak_and_raise_exceptions_macro(result, exception); /* See the declaration for this macro at the beginning of this file */
+  PL_succeed;
+}
+
+
+#ifdef LGP_WORKERS_SUPPORTED
+/**
+ * @name static int start_worker_process(worker_process *worker)
+ *
+ * @description
+ * This function forks a new worker process, connected to us through a socket pair, that parses sentences with worker_dictionary (shared copy-on-write with the Prolog process)
+ * The child process never returns to Prolog: it serves requests (see lgp-worker.c) until its socket is closed, then exits
+ * FALSE is returned if the worker can't be started
+**/
+
+static int start_worker_process(worker_process *worker) {
+
+int           fds[2]; /* fds[0] is our end of the socket pair, fds[1] is the end of the worker */
+int           i;
+pid_t         pid;
+Parse_Options opts;
+sigset_t      signal_mask;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) return FALSE;
+  if ((pid = fork()) < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return FALSE;
+  }
+  if (pid == 0) { /* Child process: only the lgp library is used from now on, never Prolog */
+    close(fds[0]);
+    for (i=0; i<nb_workers; i++)
+      if (worker_table[i].fd >= 0) close(worker_table[i].fd); /* Other workers must see an end of file when the Prolog process closes their socket */
+    sigemptyset(&signal_mask);
+    sigprocmask(SIG_SETMASK, &signal_mask, NULL); /* The signals blocked by the Prolog thread that forked us must reach the worker */
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL); /* Prolog handlers are inherited but can't run here, the worker must simply die (as in run_worker() of lgp-server.c) */
+    signal(SIGPIPE, SIG_IGN);
+    if ((opts = lgp_worker_create_parse_options(WORKER_LINKAGE_LIMIT)) != NULL)
+      lgp_worker_serve(fds[1], worker_dictionary, opts);
+    _exit(0);
+  }
+  close(fds[1]);
+  worker->pid = pid;
+  worker->fd = fds[0];
+  worker->job_index = -1; /* Idle */
+  return TRUE;
+}
+
+
+/**
+ * @name static void reap_killed_worker(worker_process *worker, int wait)
+ *
+ * @description
+ * This procedure collects the end of the previous worker process of this entry of worker_table, killed by stop_worker_process(), so that it does not remain a zombie
+ * If wait is FALSE, nothing is done if this process has not ended yet. Otherwise we wait for it, which is short as it has been sent SIGKILL
+**/
+
+static void reap_killed_worker(worker_process *worker, int wait) {
+
+pid_t pid;
+
+  if (worker->killed_pid <= 0) return;
+  while ((pid = waitpid(worker->killed_pid, NULL, (wait ? 0 : WNOHANG))) < 0 && errno == EINTR);
+  if (pid != 0) worker->killed_pid = 0; /* Collected (or not our child anymore) */
+}
+
+
+/**
+ * @name static void stop_worker_process(worker_process *worker)
+ *
+ * @description
+ * This procedure stops a worker process (if it has not crashed already)
+ * The worker is killed with SIGKILL, which it can neither catch nor block. Its end is collected later on by reap_killed_worker(), so that this procedure doesn't wait for it with the library mutex held
+**/
+
+static void stop_worker_process(worker_process *worker) {
+
+  if (worker->fd >= 0) close(worker->fd); /* An idle worker exits when it reads the end of file */
+  if (worker->pid > 0) {
+    kill(worker->pid, SIGKILL); /* In case it is in the middle of a parse. The worker owns nothing that must be cleaned up */
+    reap_killed_worker(worker, TRUE); /* The previous worker of this entry has been killed long ago, so this does not block */
+    worker->killed_pid = worker->pid;
+    reap_killed_worker(worker, FALSE);
+  }
+  worker->pid = 0;
+  worker->fd = -1;
+  worker->job_index = -1;
+}
+
+
+/**
+ * @name static double current_time()
+ *
+ * @description
+ * This function returns the current time in seconds, as get_time/1 does, so that it can be compared with the deadlines of parse jobs
+**/
+
+static double current_time() {
+
+struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (double)now.tv_sec + (double)now.tv_usec / 1e6;
+}
+
+
+/**
+ * @name static long find_job(unsigned int id)
+ *
+ * @description
+ * This function returns the index in job_table of the parse job whose identifier is id, or -1 if there is none (the job has been collected already)
+**/
+
+static long find_job(unsigned int id) {
+
+size_t job_index;
+
+  for (job_index=0; job_index<job_table_size; job_index++)
+    if (id != 0 && job_table[job_index].id == id) return (long)job_index;
+  return -1;
+}
+
+
+/**
+ * @name static long create_job(char *text, size_t text_length, int priority, double deadline)
+ *
+ * @description
+ * This function records a new parse job in job_table (growing it if needed), in the queued state, and returns its index. The job takes over text
+ * -1 is returned if memory can't be allocated
+**/
+
+static long create_job(char *text, size_t text_length, int priority, double deadline) {
+
+size_t    job_index, new_size;
+parse_job *new_table;
+parse_job *job;
+
+  for (job_index=0; job_index<job_table_size && job_table[job_index].id != 0; job_index++);
+  if (job_index == job_table_size) {
+    new_size = (job_table_size ? 2*job_table_size : 16);
+    if ((new_table = realloc(job_table, new_size * sizeof(parse_job))) == NULL) return -1;
+    memset(new_table + job_table_size, 0, (new_size - job_table_size) * sizeof(parse_job)); /* New entries are free */
+    job_table = new_table;
+    job_table_size = new_size;
+  }
+  job = &job_table[job_index];
+  memset(job, 0, sizeof(parse_job));
+  if (++last_job_id > INT_MAX) last_job_id = 1; /* Identifiers must fit in the integer of the handle */
+  job->id = last_job_id;
+  job->priority = priority;
+  job->deadline = deadline;
+  job->sequence = ++last_job_sequence;
+  job->state = PARSE_JOB_QUEUED;
+  job->text = text;
+  job->text_length = text_length;
+  job->worker_index = -1;
+  if (++parse_class_table[priority].nb_queued > parse_class_table[priority].max_queued) parse_class_table[priority].max_queued = parse_class_table[priority].nb_queued;
+  return (long)job_index;
+}
+
+
+/**
+ * @name static void finish_job(long job_index, int status, char *result)
+ *
+ * @description
+ * This procedure records the end of a parse job (running or still queued) with the given status and result (taken over by the job)
+**/
+
+static void finish_job(long job_index, int status, char *result) {
+
+parse_job *job = &job_table[job_index];
+
+  if (job->state == PARSE_JOB_QUEUED) parse_class_table[job->priority].nb_queued--;
+  if (job->state == PARSE_JOB_RUNNING) {
+    parse_class_table[job->priority].nb_running--;
+    worker_table[job->worker_index].job_index = -1;
+    job->worker_index = -1;
+  }
+  job->state = PARSE_JOB_DONE;
+  job->status = status;
+  job->result = result;
+  parse_class_table[job->priority].nb_completed++;
+  if (job->deadline != HUGE_VAL && current_time() > job->deadline) parse_class_table[job->priority].nb_deadline_missed++;
+}
+
+
+/**
+ * @name static void delete_job(long job_index)
+ *
+ * @description
+ * This procedure removes a parse job from job_table. A running job is first stopped by restarting its worker, so that its answer is not mixed with the ones of the next jobs
+**/
+
+static void delete_job(long job_index) {
+
+parse_job      *job = &job_table[job_index];
+worker_process *worker;
+
+  if (job->state == PARSE_JOB_RUNNING) {
+    worker = &worker_table[job->worker_index];
+    stop_worker_process(worker);
+    start_worker_process(worker); /* If it fails, the next job sent to this worker will try again */
+    parse_class_table[job->priority].nb_running--;
+  }
+  else if (job->state == PARSE_JOB_QUEUED) parse_class_table[job->priority].nb_queued--;
+  PL_free(job->text);
+  free(job->result);
+  memset(job, 0, sizeof(parse_job));
+}
+
+
+/**
+ * @name static void run_job(int worker_index, long job_index)
+ *
+ * @description
+ * This procedure sends a queued parse job to an idle worker. If the worker died while idle, it is restarted, and the job is done with WORKER_STATUS_CRASHED if it still can't be sent
+**/
+
+static void run_job(int worker_index, long job_index) {
+
+parse_job      *job = &job_table[job_index];
+worker_process *worker = &worker_table[worker_index];
+int            attempt;
+
+  for (attempt=0; attempt<2; attempt++) {
+    if (attempt > 0) { /* This worker died while idle, replace it and try again */
+      stop_worker_process(worker);
+      if (!start_worker_process(worker)) break;
+    }
+    if (job->estimate ?
+        lgp_worker_send_request(worker->fd, LGP_WORKER_REQUEST_ESTIMATE, job->text, job->text_length) :
+        job->has_options ?
+        lgp_worker_send_request_with_options(worker->fd, job->options, job->text, job->text_length) :
+        lgp_worker_send_request(worker->fd, LGP_WORKER_REQUEST_PARSE, job->text, job->text_length)) {
+      parse_class_table[job->priority].nb_queued--;
+      parse_class_table[job->priority].nb_running++;
+      job->state = PARSE_JOB_RUNNING;
+      job->worker_index = worker_index;
+      worker->job_index = job_index;
+      return;
+    }
+  }
+  finish_job(job_index, WORKER_STATUS_CRASHED, NULL);
+}
+
+
+/**
+ * @name static int job_precedes(parse_job *job, parse_job *other_job, int expensive_first)
+ *
+ * @description
+ * This function tells whether job must run before other_job: the most urgent priority class first, then the earliest deadline, then the first submitted
+ * If expensive_first is TRUE (for the last worker), expensive jobs come before all the other ones (see worker_parse_batch/3)
+**/
+
+static int job_precedes(parse_job *job, parse_job *other_job, int expensive_first) {
+
+  if (expensive_first && job->expensive != other_job->expensive) return job->expensive;
+  if (job->priority != other_job->priority) return (job->priority < other_job->priority);
+  if (job->deadline != other_job->deadline) return (job->deadline < other_job->deadline);
+  return (job->sequence < other_job->sequence);
+}
+
+
+/**
+ * @name static long next_queued_job(int worker_index)
+ *
+ * @description
+ * This function returns the index of the queued parse job that the worker worker_index should run next (or any worker if worker_index is -1), or -1 if there is none
+ * Jobs of a class that already runs its max_running jobs are not taken
+ * Expensive jobs form the queue of the last worker, that takes them from the head (the first one in job_precedes() order). Another worker only takes one when it has nothing else to do and the last worker is busy: it then steals the one at the tail, that the last worker would have run last
+**/
+
+static long next_queued_job(int worker_index) {
+
+size_t job_index;
+long   best_job_index = -1;
+long   stolen_job_index = -1; /* Tail of the queue of the last worker, for another idle worker */
+int    last_worker = (worker_index == nb_workers-1);
+
+  for (job_index=0; job_index<job_table_size; job_index++) {
+    parse_job *job = &job_table[job_index];
+    if (job->id == 0 || job->state != PARSE_JOB_QUEUED) continue;
+    if (parse_class_table[job->priority].nb_running >= parse_class_table[job->priority].max_running) continue;
+    if (job->expensive && worker_index >= 0 && !last_worker) {
+      if (stolen_job_index < 0 || job_precedes(&job_table[stolen_job_index], job, FALSE)) stolen_job_index = (long)job_index;
+      continue;
+    }
+    if (best_job_index < 0 || job_precedes(job, &job_table[best_job_index], last_worker)) best_job_index = (long)job_index;
+  }
+  if (best_job_index < 0 && stolen_job_index >= 0 && worker_table[nb_workers-1].job_index >= 0) return stolen_job_index;
+  return best_job_index;
+}
+
+
+/**
+ * @name static long preemption_victim(long job_index)
+ *
+ * @description
+ * This function returns the index of the running parse job that should give its worker to the queued job job_index, or -1 if no running job is less urgent
+ * Only jobs of a less urgent priority class are preempted, the least urgent one first (latest deadline, then last submitted). Jobs already preempted MAX_JOB_PREEMPTIONS times are not preempted anymore
+**/
+
+static long preemption_victim(long job_index) {
+
+size_t job_index_scanned;
+long   victim_index = -1;
+parse_job *job = &job_table[job_index];
+
+  for (job_index_scanned=0; job_index_scanned<job_table_size; job_index_scanned++) {
+    parse_job *running_job = &job_table[job_index_scanned];
+    if (running_job->id == 0 || running_job->state != PARSE_JOB_RUNNING || running_job->priority <= job->priority) continue;
+    if (running_job->nb_preemptions >= MAX_JOB_PREEMPTIONS) continue;
+    if (job->expensive && running_job->worker_index != nb_workers-1) continue;
+    if (victim_index < 0 || job_precedes(&job_table[victim_index], running_job, FALSE)) victim_index = (long)job_index_scanned;
+  }
+  return victim_index;
+}
+
+
+/**
+ * @name static void schedule_jobs()
+ *
+ * @description
+ * This procedure gives queued parse jobs to the idle workers, the last one first (see next_queued_job() for the expensive jobs of worker_parse_batch/3: the last worker takes the head of their queue, so that the other idle workers can steal from its tail in the same pass). Then, while a queued job is more urgent than a running one, the running job is stopped (its worker is restarted) and queued again, and its worker gets the urgent job
+ * Preempted jobs keep their submission order, so they are run again before the jobs submitted after them. A job is preempted at most MAX_JOB_PREEMPTIONS times, so that bulk jobs are done even under a steady flow of urgent jobs
+**/
+
+static void schedule_jobs() {
+
+int  worker_rank;
+int  worker_index;
+long job_index, victim_index;
+
+  for (worker_rank=0; worker_rank<nb_workers; worker_rank++) {
+    worker_index = (worker_rank + nb_workers - 1) % nb_workers; /* nb_workers-1, then 0, 1... */
+    if (worker_table[worker_index].job_index >= 0) continue;
+    if ((job_index = next_queued_job(worker_index)) < 0) continue;
+    if (job_table[job_index].expensive && worker_index != nb_workers-1) parse_class_table[job_table[job_index].priority].nb_stolen++;
+    run_job(worker_index, job_index);
+  }
+  while ((job_index = next_queued_job(-1)) >= 0 && (victim_index = preemption_victim(job_index)) >= 0) {
+    parse_job *victim = &job_table[victim_index];
+    worker_index = victim->worker_index;
+    stop_worker_process(&worker_table[worker_index]);
+    start_worker_process(&worker_table[worker_index]); /* If it fails, run_job() tries again */
+    parse_class_table[victim->priority].nb_running--;
+    parse_class_table[victim->priority].nb_queued++;
+    parse_class_table[victim->priority].nb_preempted++;
+    victim->nb_preemptions++;
+    victim->state = PARSE_JOB_QUEUED;
+    victim->worker_index = -1;
+    run_job(worker_index, job_index);
+  }
+}
+
+
+/**
+ * @name static int collect_worker_answers(int timeout)
+ *
+ * @description
+ * This function waits up to timeout ms (as poll() does) for answers from the busy workers, and records the end of the jobs that have been answered
+ * A worker that died while running a job is restarted, and its job is done with WORKER_STATUS_CRASHED
+ * FALSE is returned if poll() failed
+**/
+
+static int collect_worker_answers(int timeout) {
+
+struct pollfd poll_table[MAX_NB_WORKERS];
+int           poll_worker[MAX_NB_WORKERS]; /* Worker index corresponding to each entry of poll_table */
+int           worker_index, nb_polled = 0, i;
+int           status;
+long          job_index;
+text_buffer   buffer = {NULL, 0, 0};
+char          *result;
+
+  for (worker_index=0; worker_index<nb_workers; worker_index++) {
+    reap_killed_worker(&worker_table[worker_index], FALSE);
+    if (worker_table[worker_index].job_index < 0) continue;
+    poll_table[nb_polled].fd = worker_table[worker_index].fd;
+    poll_table[nb_polled].events = POLLIN;
+    poll_worker[nb_polled++] = worker_index;
+  }
+  if (nb_polled == 0) return TRUE;
+  if (poll(poll_table, nb_polled, timeout) < 0) return (errno == EINTR);
+  for (i=0; i<nb_polled; i++) {
+    worker_process *worker = &worker_table[poll_worker[i]];
+    if (poll_table[i].revents == 0) continue;
+    job_index = worker->job_index;
+    if (lgp_worker_read_response(worker->fd, &status, &buffer)) {
+      result = NULL;
+      if (status == LGP_WORKER_STATUS_OK && (result = strdup(buffer.text)) == NULL) status = LGP_WORKER_STATUS_NOT_ENOUGH_MEMORY;
+      finish_job(job_index, status, result);
+    }
+    else { /* The worker died while parsing this sentence */
+      finish_job(job_index, WORKER_STATUS_CRASHED, NULL);
+      stop_worker_process(worker);
+      start_worker_process(worker); /* If it fails, the next job sent to this worker will try again */
+    }
+  }
+  free(buffer.text);
+  return TRUE;
+}
+
+
+/**
+ * @name static int release_nested_library_locks(void)
+ *
+ * @description
+ * A recursive mutex is only released once all its locks are. The calling thread may hold the library mutex more than once (when a predicate is called from another one), so before waiting for other threads or for the workers, this function releases all its locks but the last one
+ * The number of locks released is returned, to be given to restore_nested_library_locks() once the wait is over
+**/
+
+static int release_nested_library_locks(void) {
+
+int nb_locks = lgp_library_lock_depth - 1;
+int i;
+
+  for (i=0; i<nb_locks; i++) lgp_library_unlock();
+  return nb_locks;
+}
+
+
+/**
+ * @name static void restore_nested_library_locks(int nb_locks)
+ *
+ * @description
+ * This procedure takes again the nb_locks locks of the library mutex released by release_nested_library_locks()
+**/
+
+static void restore_nested_library_locks(int nb_locks) {
+
+int i;
+
+  for (i=0; i<nb_locks; i++) lgp_library_lock();
+}
+
+
+/**
+ * @name static int wait_for_job(unsigned int id)
+ *
+ * @description
+ * This function runs the scheduler until the parse job id is done. FALSE is returned if it can't be done (poll() failed, the job has been deleted by another thread, or the workers have been stopped)
+ * The library mutex is released while waiting for the workers, so that other threads can submit jobs meanwhile (an urgent job then preempts the running ones, see schedule_jobs())
+ * The wait is done in slices of SCHEDULER_POLL_INTERVAL ms, as the workers may be restarted by other threads while we don't hold the mutex. A job held back by its class limit (see set_parse_class_limit/2), or by a worker that failed to restart, is waited for as well, until a worker can run it
+ * The signals of the calling Prolog thread are handled after each slice. FALSE is also returned if a signal handler raised an exception, that the caller must let Prolog raise (PL_exception(0) is then set)
+**/
+
+static int wait_for_job(unsigned int id) {
+
+struct pollfd poll_table[MAX_NB_WORKERS];
+int           worker_index, nb_polled;
+int           nb_nested_locks;
+long          job_index;
+
+  while (1) {
+    if (!collect_worker_answers(0)) return FALSE;
+    schedule_jobs();
+    if ((job_index = find_job(id)) < 0) return FALSE;
+    if (job_table[job_index].state == PARSE_JOB_DONE) return TRUE;
+    if (nb_workers == 0) return FALSE; /* No worker can ever run the job */
+    nb_polled = 0;
+    for (worker_index=0; worker_index<nb_workers; worker_index++) {
+      if (worker_table[worker_index].job_index < 0) continue;
+      poll_table[nb_polled].fd = worker_table[worker_index].fd;
+      poll_table[nb_polled++].events = POLLIN;
+    }
+    nb_nested_locks = release_nested_library_locks();
+    lgp_library_unlock();
+    poll(poll_table, nb_polled, SCHEDULER_POLL_INTERVAL); /* Answers are read by collect_worker_answers() once we hold the mutex again. With nothing to poll (the job is held back), this just sleeps */
+    lgp_library_lock();
+    restore_nested_library_locks(nb_nested_locks);
+    if (PL_handle_signals() < 0) return FALSE; /* Interrupted */
+  }
+}
+
+
+/**
+ * @name static char *job_error_reason(int status)
+ *
+ * @description
+ * This function returns the reason of the lgp_api_error(sentence, Reason) exception corresponding to the status of a parse job, or NULL for LGP_WORKER_STATUS_OK
+**/
+
+static char *job_error_reason(int status) {
+
+  switch (status) {
+  case LGP_WORKER_STATUS_OK: return NULL;
+  case LGP_WORKER_STATUS_SENTENCE_TOO_LONG: return "too_long";
+  case LGP_WORKER_STATUS_SENTENCE_CANT_REGISTER: return "cant_register";
+  case WORKER_STATUS_CRASHED: return "worker_crashed";
+  case WORKER_STATUS_STOPPED: return "workers_stopped";
+  default: return "not_enough_memory";
+  }
+}
+
+
+/**
+ * @name static void delete_all_jobs()
+ *
+ * @description
+ * This procedure deletes all the parse jobs and frees job_table (when the library is unloaded)
+**/
+
+static void delete_all_jobs() {
+
+size_t job_index;
+
+  for (job_index=0; job_index<job_table_size; job_index++)
+    if (job_table[job_index].id != 0) delete_job(job_index);
+  free(job_table);
+  job_table = NULL;
+  job_table_size = 0;
+}
+#endif
+
+
+/**
+ * @name static foreign_t raise_worker_exception(char *reason)
+ *
+ * @description
+ * This function raises lgp_api_error(workers, reason)
+**/
+
+static foreign_t raise_worker_exception(char *reason) {
+
+term_t exception = PL_new_term_ref();
+
+  PL_unify_term(exception,
+                PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                PL_CHARS, "workers",
+                PL_CHARS, reason);
+  return PL_raise_exception(exception);
+}
+
+
+/**
+ * @name foreign_t pl_start_workers(term_t t_nb_workers, term_t dictionary_handle)
+ * @prologname start_workers/2
+ *
+ * @description
+ * This predicate starts t_nb_workers worker processes that parse the sentences given to worker_parse_batch/2 with the dictionary of dictionary_handle
+ * Workers are forked processes sharing the dictionary with the Prolog process copy-on-write, so that an lgp library crash (or exit) on one sentence only kills one worker. Such a worker is restarted automatically
+ * The dictionary remains loaded until stop_workers/0 is called, even if its dictionary object is deleted or reloaded meanwhile
+**/
+
+foreign_t pl_start_workers(term_t t_nb_workers, term_t dictionary_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t                  exception; /* Handle for a possible exception */
+int                     nb_new_workers; /* Number of workers to start */
+unsigned int            dict_handle_index; /* Handle index for the dictionary used */
+dict_linked_list_object *dict_object; /* Linked object corresponding to the handle, in the dictionary chained-list */
+int                     i;
+
+  if (nb_workers > 0) return raise_worker_exception("already_started");
+  if (!PL_get_integer(t_nb_workers, &nb_new_workers) || nb_new_workers < 1 || nb_new_workers > MAX_NB_WORKERS)
+    return raise_worker_exception("bad_number");
+
+  if (!get_index_from_handle(FUNCTOR_dictionary1, dictionary_handle, &dict_handle_index)) {
+    exception = PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "dictionary",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("dictionary", NULL,
+                                                                            root_dict_list, dict_handle_index, (generic_linked_list_object **)&dict_object)) {
+    PL_fail; /* get_object_from_handle_index_in_chained_list failed and prepared an exception. PL_fail will return to Prolog and raise the pending exception */
+  }
+  worker_dictionary = dict_object->payload;
+  acquire_dictionary(worker_dictionary); /* Workers restarted later on need the same dictionary */
+
+  for (i=0; i<nb_new_workers; i++) {
+    if (!start_worker_process(&worker_table[i])) {
+      while (--i >= 0) {
+        stop_worker_process(&worker_table[i]);
+        reap_killed_worker(&worker_table[i], TRUE);
+      }
+      release_dictionary(worker_dictionary);
+      worker_dictionary = NULL;
+      return raise_worker_exception("cant_start");
+    }
+    nb_workers = i+1; /* Workers started later on close the sockets of the previous ones */
+  }
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_stop_workers()
+ * @prologname stop_workers/0
+ *
+ * @description
+ * This predicate stops all the worker processes started by start_workers/2 (it succeeds if there are none)
+ * Parse jobs that are not done yet are ended with the workers_stopped error, that parse_wait/2 raises
+**/
+
+foreign_t pl_stop_workers() {
+
+#ifdef LGP_WORKERS_SUPPORTED
+int i;
+
+  if (nb_workers == 0) PL_succeed;
+  for (i=0; i<(int)job_table_size; i++)
+    if (job_table[i].id != 0 && job_table[i].state != PARSE_JOB_DONE) finish_job(i, WORKER_STATUS_STOPPED, NULL); /* parse_wait/2 will raise lgp_api_error(sentence, workers_stopped) */
+  for (i=0; i<nb_workers; i++) {
+    stop_worker_process(&worker_table[i]);
+    reap_killed_worker(&worker_table[i], TRUE);
+  }
+  nb_workers = 0;
+  release_dictionary(worker_dictionary);
+  worker_dictionary = NULL;
+#endif
+  PL_succeed;
+}
+
+
+/**
+ * @name foreign_t pl_get_worker_pids(term_t pid_list)
+ * @prologname get_worker_pids/1
+ *
+ * @description
+ * This predicate unifies pid_list with the list of the process ids of the worker processes started by start_workers/2, in worker order ([] if there are none)
+ * A worker restarted after a crash gets a new process id
+**/
+
+foreign_t pl_get_worker_pids(term_t pid_list) {
+
+term_t constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+#ifdef LGP_WORKERS_SUPPORTED
+term_t new_element; /* Term used to construct each element */
+int    i;
+#endif
+
+  PL_put_nil(constructed_list); /* Create the tail of the list (which is []), elements are then added from the last to the first one */
+#ifdef LGP_WORKERS_SUPPORTED
+  collect_worker_answers(0); /* Workers that crashed while parsing are restarted */
+  for (i=nb_workers-1; i>=0; i--) {
+    if (!(PL_unify_integer(new_element = PL_new_term_ref(), (long)worker_table[i].pid) &&
+          PL_cons_list(constructed_list, new_element, constructed_list))) {
+      return raise_worker_exception("cant_create_info_term");
+    }
+  }
+#endif
+  return PL_unify(pid_list, constructed_list);
+}
+
+
+#ifdef LGP_WORKERS_SUPPORTED
+/**
+ * @name static char *estimate_batch_sentences(char **sentence, size_t *sentence_length, size_t nb_sentences, double *nb_disjuncts)
+ *
+ * @description
+ * This function estimates the cost of the parse of each sentence of a batch as estimate_parse_cost/3 does, with the dictionary and the disjunct_cost of the worker processes, and stores its number of disjuncts in nb_disjuncts[i]
+ * The estimates are parse jobs run by the workers (see LGP_WORKER_REQUEST_ESTIMATE), so that a sentence that crashes the lgp library while it is tokenised kills a worker and not the Prolog process
+ * nb_disjuncts[i] is set to -1 for a sentence that can't be estimated. It is left in the cheap lane, and its parse will report the error
+ * The reason of the lgp_api_error(sentence, Reason) exception to raise is returned, or NULL if there is none
+**/
+
+static char *estimate_batch_sentences(char **sentence, size_t *sentence_length, size_t nb_sentences, double *nb_disjuncts) {
+
+unsigned int *job_id; /* Identifier of the estimate job of each sentence */
+char         *text; /* Copy of the text of a sentence, given to its estimate job */
+char         *reason = NULL;
+long         job_index;
+size_t       i;
+
+  for (i=0; i<nb_sentences; i++) nb_disjuncts[i] = -1.0;
+  if ((job_id = calloc(nb_sentences, sizeof(unsigned int))) == NULL) return "not_enough_memory";
+  for (i=0; i<nb_sentences; i++) {
+    text = PL_malloc(sentence_length[i] + 1);
+    memcpy(text, sentence[i], sentence_length[i]);
+    if ((job_index = create_job(text, sentence_length[i], PARSE_PRIORITY_NORMAL, HUGE_VAL)) < 0) {
+      PL_free(text);
+      reason = "not_enough_memory";
+      break;
+    }
+    job_table[job_index].estimate = TRUE;
+    job_id[i] = job_table[job_index].id;
+  }
+  for (i=0; i<nb_sentences; i++) {
+    if (job_id[i] == 0) continue;
+    if (reason == NULL && !wait_for_job(job_id[i])) reason = "poll_failed"; /* Or interrupted, see pl_worker_parse_batch() */
+    if ((job_index = find_job(job_id[i])) < 0) continue;
+    if (job_table[job_index].state == PARSE_JOB_DONE && job_table[job_index].status == LGP_WORKER_STATUS_OK && job_table[job_index].result != NULL)
+      nb_disjuncts[i] = strtod(job_table[job_index].result, NULL);
+    delete_job(job_index);
+  }
+  free(job_id);
+  return reason;
+}
+
+
+/**
+ * @name static int get_parse_priority(term_t t_priority)
+ *
+ * @description
+ * This function returns the PARSE_PRIORITY_xxx value of the priority class named by the atom t_priority (interactive, normal or bulk), or -1 if it is not a priority class
+**/
+
+static int get_parse_priority(term_t t_priority) {
+
+char *priority_name;
+int  priority;
+
+  if (!PL_get_atom_chars(t_priority, &priority_name)) return -1;
+  for (priority=0; priority<NB_PARSE_PRIORITIES; priority++)
+    if (strcmp(priority_name, parse_priority_name[priority]) == 0) return priority;
+  return -1;
+}
+
+
+/**
+ * @name static foreign_t raise_parse_job_exception(char *reason)
+ *
+ * @description
+ * This function raises lgp_api_error(parse_job, reason)
+**/
+
+static foreign_t raise_parse_job_exception(char *reason) {
+
+term_t exception = PL_new_term_ref();
+
+  PL_unify_term(exception,
+                PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                PL_CHARS, "parse_job",
+                PL_CHARS, reason);
+  return PL_raise_exception(exception);
+}
+
+
+/**
+ * @name static void get_worker_options(Parse_Options opts, int *options)
+ *
+ * @description
+ * This procedure copies the settings of opts that are sent to the workers with a parse job into options (indexed by LGP_WORKER_OPTION_xxx)
+**/
+
+static void get_worker_options(Parse_Options opts, int *options) {
+
+  options[LGP_WORKER_OPTION_LINKAGE_LIMIT] = parse_options_get_linkage_limit(opts);
+  options[LGP_WORKER_OPTION_DISJUNCT_COST] = parse_options_get_disjunct_cost(opts);
+  options[LGP_WORKER_OPTION_MIN_NULL_COUNT] = parse_options_get_min_null_count(opts);
+  options[LGP_WORKER_OPTION_MAX_NULL_COUNT] = parse_options_get_max_null_count(opts);
+  options[LGP_WORKER_OPTION_ISLANDS_OK] = parse_options_get_islands_ok(opts);
+  options[LGP_WORKER_OPTION_MAX_PARSE_TIME] = parse_options_get_max_parse_time(opts);
+  options[LGP_WORKER_OPTION_MAX_MEMORY] = parse_options_get_max_memory(opts);
+}
+
+
+/**
+ * @name static int find_pipeline(unsigned int id)
+ *
+ * @description
+ * This function returns the slot in pipeline_table of the pipeline whose identifier is id, or -1 if there is none (it has been deleted)
+**/
+
+static int find_pipeline(unsigned int id) {
+
+int slot;
+
+  for (slot=0; slot<NB_PIPELINES; slot++)
+    if (id != 0 && pipeline_table[slot].id == id) return slot;
+  return -1;
+}
+
+
+/**
+ * @name static void delete_pipeline_slot(int slot)
+ *
+ * @description
+ * This procedure deletes the pipeline of pipeline_table[slot] and the parse jobs of the sentences it contains, then wakes up the threads waiting on it
+ * The jobs of sentences being popped belong to their consumer, that deletes them
+**/
+
+static void delete_pipeline_slot(int slot) {
+
+pipeline *target = &pipeline_table[slot];
+long     job_index;
+size_t   i;
+
+  for (i=0; i<target->nb_jobs; i++)
+    if ((job_index = find_job(target->job_id[(target->head + i) % target->capacity])) >= 0) delete_job(job_index);
+  free(target->job_id);
+  memset(target, 0, sizeof(pipeline));
+  pthread_cond_broadcast(&pipeline_changed);
+}
+
+
+/**
+ * @name static foreign_t raise_pipeline_exception(char *reason)
+ *
+ * @description
+ * This function raises lgp_api_error(pipeline, reason)
+**/
+
+static foreign_t raise_pipeline_exception(char *reason) {
+
+term_t exception = PL_new_term_ref();
+
+  PL_unify_term(exception,
+                PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                PL_CHARS, "pipeline",
+                PL_CHARS, reason);
+  return PL_raise_exception(exception);
+}
+#endif
+
+
+/**
+ * @name foreign_t pl_worker_parse_batch(term_t sentence_list, term_t t_cost_lanes, term_t linkage_lists, term_t cost_class_list)
+ * @prologname worker_parse_batch_/4
+ *
+ * @description
+ * This predicate parses all the sentences of sentence_list with the worker processes started by start_workers/2, and unifies linkage_lists with the list of the linkage lists of these sentences (each linkage in the format of get_linkage/2)
+ * Each sentence is submitted as a parse job of the normal priority class (see parse_submit/5), all of them before waiting for the first one, so up to one sentence per worker is parsed at the same time
+ * If t_cost_lanes is 1 and there are several workers, the cost of each sentence is estimated first by the workers (see estimate_batch_sentences()): the last worker is the lane of the expensive sentences (it takes cheaper ones when no expensive sentence is left), and the other workers take the sentences that are not expensive first, so that a few long parses don't delay the whole batch
+ * Once they have no cheaper sentence left, the other workers steal the expensive sentences from the end of the lane while the last worker is busy, so that no worker stays idle behind the expensive ones
+ * cost_class_list is unified with the estimated cost class of each sentence (cheap, medium or expensive, as given by estimate_parse_cost/3), the expensive ones being those of the expensive lane. It is unknown for the sentences that have not been estimated
+ * A worker that dies while parsing a sentence is restarted, and the sentence gets a lgp_api_error(sentence, worker_crashed) error. All sentences are parsed in any case, then the error of the first sentence that failed (if any) is raised
+**/
+
+foreign_t pl_worker_parse_batch(term_t sentence_list, term_t t_cost_lanes, term_t linkage_lists, term_t cost_class_list) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t        exception; /* Handle for a possible exception */
+term_t        list = PL_copy_term_ref(sentence_list);
+term_t        head = PL_new_term_ref();
+term_t        new_linkage_list; /* Linkage list of one sentence, read from the text sent by a worker */
+term_t        constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t        constructed_class_list = PL_new_term_ref(); /* Same for cost_class_list */
+term_t        new_class = PL_new_term_ref();
+size_t        nb_sentences = 0, nb_allocated = 0, i;
+char          **sentence = NULL; /* Text of each sentence (allocated by PL_get_nchars()), until it is given to its parse job */
+size_t        *sentence_length = NULL;
+double        *nb_disjuncts = NULL; /* Estimated number of disjuncts of each sentence, -1 if it has not been estimated */
+unsigned int  *job_id = NULL; /* Identifier of the parse job of each sentence */
+char          **result = NULL; /* Prolog text of the linkage list of each sentence, as sent by the worker */
+long          job_index;
+int           cost_lanes = 0;
+char          *reason = NULL; /* Reason of the exception to raise, if any */
+char          *sentence_reason = NULL; /* Reason of the error of the first sentence that failed, if any */
+void          *new_block;
+
+  if (nb_workers == 0) return raise_worker_exception("not_started");
+  if (!PL_get_integer(t_cost_lanes, &cost_lanes)) return raise_worker_exception("bad_option");
+
+  while (PL_get_list(list, head, list)) { /* Get the text of all sentences before submitting them */
+    if (nb_sentences == nb_allocated) {
+      nb_allocated = (nb_allocated ? 2*nb_allocated : 16);
+      if ((new_block = realloc(sentence, nb_allocated * sizeof(char *))) != NULL) sentence = new_block;
+      if (new_block != NULL && (new_block = realloc(sentence_length, nb_allocated * sizeof(size_t))) != NULL) sentence_length = new_block;
+      if (new_block == NULL) {
+        reason = "not_enough_memory";
+        break;
+      }
+    }
+    if (!PL_get_nchars(head, &sentence_length[nb_sentences], &sentence[nb_sentences], CVT_ATOM|CVT_STRING|CVT_LIST|BUF_MALLOC)) {
+      reason = "instanciation_fault";
+      break;
+    }
+    nb_sentences++;
+  }
+  if (reason == NULL && !PL_get_nil(list)) reason = "instanciation_fault";
+  if (reason == NULL && nb_sentences > 0) {
+    result = calloc(nb_sentences, sizeof(char *));
+    job_id = calloc(nb_sentences, sizeof(unsigned int));
+    nb_disjuncts = calloc(nb_sentences, sizeof(double));
+    if (result == NULL || job_id == NULL || nb_disjuncts == NULL) reason = "not_enough_memory";
+    for (i=0; reason == NULL && i<nb_sentences; i++) nb_disjuncts[i] = -1.0;
+  }
+  if (reason == NULL && cost_lanes && nb_workers > 1) reason = estimate_batch_sentences(sentence, sentence_length, nb_sentences, nb_disjuncts);
+
+  for (i=0; i<nb_sentences && reason == NULL; i++) {
+    if ((job_index = create_job(sentence[i], sentence_length[i], PARSE_PRIORITY_NORMAL, HUGE_VAL)) < 0) {
+      reason = "not_enough_memory";
+      break;
+    }
+    sentence[i] = NULL; /* The text now belongs to the job */
+    job_table[job_index].expensive = (nb_disjuncts[i] >= PARSE_COST_EXPENSIVE_DISJUNCTS);
+    job_id[i] = job_table[job_index].id;
+  }
+
+  for (i=0; i<nb_sentences && job_id != NULL; i++) { /* Jobs are collected in order, the later ones are still waited for after a sentence error */
+    if (job_id[i] == 0) continue;
+    if (reason == NULL && !wait_for_job(job_id[i])) reason = "poll_failed"; /* Or interrupted, see below */
+    if ((job_index = find_job(job_id[i])) < 0) continue;
+    if (job_table[job_index].state == PARSE_JOB_DONE) {
+      if (sentence_reason == NULL) sentence_reason = job_error_reason(job_table[job_index].status);
+      result[i] = job_table[job_index].result;
+      job_table[job_index].result = NULL;
+    }
+    delete_job(job_index); /* After a failure, the jobs not done are deleted, their workers being restarted */
+  }
+  if (reason == NULL) reason = sentence_reason;
+
+  PL_put_nil(constructed_list);
+  PL_put_nil(constructed_class_list);
+  for (i=nb_sentences; reason == NULL && i>0; i--) { /* The lists are built from their tail */
+    new_linkage_list = PL_new_term_ref();
+    if (!PL_chars_to_term(result[i-1], new_linkage_list)) reason = "bad_response";
+    else PL_cons_list(constructed_list, new_linkage_list, constructed_list);
+    PL_put_atom_chars(new_class, (nb_disjuncts[i-1] < 0.0 ? "unknown" : parse_cost_class(nb_disjuncts[i-1])));
+    PL_cons_list(constructed_class_list, new_class, constructed_class_list);
+  }
+
+  for (i=0; i<nb_sentences; i++) {
+    if (sentence[i] != NULL) PL_free(sentence[i]);
+    if (result != NULL) free(result[i]);
+  }
+  free(sentence);
+  free(sentence_length);
+  free(result);
+  free(job_id);
+  free(nb_disjuncts);
+
+  if (reason != NULL && PL_exception(0)) PL_fail; /* wait_for_job() has been interrupted: let Prolog raise the exception of the signal handler */
+  if (reason != NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "sentence",
+                  PL_CHARS, reason);
+    return PL_raise_exception(exception);
+  }
+  return (PL_unify(linkage_lists, constructed_list) && PL_unify(cost_class_list, constructed_class_list));
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_parse_submit(term_t t_input_sentence, term_t parse_options_handle, term_t t_priority, term_t t_deadline, term_t job_handle)
+ * @prologname parse_submit/5
+ *
+ * @description
+ * This predicate submits the parse of a sentence (an atom, a string or a code list) to the worker processes started by start_workers/2, and unifies job_handle with a handle on this parse job. It doesn't wait for the parse, see parse_wait/2
+ * The sentence is parsed with the linkage_limit, disjunct_cost, min_null_count, max_null_count, islands_ok, max_parse_time and max_memory of the parse options of parse_options_handle (as they are when the job is submitted)
+ * t_priority is the priority class of the job (interactive, normal or bulk) and t_deadline the time (as given by get_time/1) at which it should be done, or none
+ * Queued jobs are run by priority class first, then by earliest deadline. A job also stops a running job of a less urgent class when no worker is idle (the stopped job is queued again), and set_parse_class_limit/2 limits the number of workers each class can use
+**/
+
+foreign_t pl_parse_submit(term_t t_input_sentence, term_t parse_options_handle, term_t t_priority, term_t t_deadline, term_t job_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t                  exception;
+unsigned int            handle_index;
+opts_linked_list_object *opts_object; /* Linked object corresponding to the parse options handle */
+Parse_Options           opts;
+int                     priority;
+double                  deadline;
+char                    *deadline_name;
+char                    *text; /* Text of the sentence, given to the job */
+size_t                  text_length;
+long                    job_index;
+parse_job               *job;
+
+  if (nb_workers == 0) return raise_worker_exception("not_started");
+  if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "parse_options",
+		  PL_CHARS, "bad_handle");
+    return PL_raise_exception(exception);
+  }
+  if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+    PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+  }
+  opts = opts_object->payload;
+  if ((priority = get_parse_priority(t_priority)) < 0) return raise_parse_job_exception("bad_priority");
+  if (PL_get_atom_chars(t_deadline, &deadline_name) && strcmp(deadline_name, "none") == 0) deadline = HUGE_VAL;
+  else if (!PL_get_float(t_deadline, &deadline)) return raise_parse_job_exception("bad_deadline");
+  if (!PL_get_nchars(t_input_sentence, &text_length, &text, CVT_ATOM|CVT_STRING|CVT_LIST|BUF_MALLOC)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "instanciation_fault");
+    return PL_raise_exception(exception);
+  }
+  if ((job_index = create_job(text, text_length, priority, deadline)) < 0) {
+    PL_free(text);
+    return raise_parse_job_exception("not_enough_memory");
+  }
+  job = &job_table[job_index];
+  job->has_options = TRUE;
+  get_worker_options(opts, job->options);
+
+  collect_worker_answers(0); /* Free the workers that are done before choosing the next jobs */
+  schedule_jobs();
+  return unify_handle_with_index(FUNCTOR_parsejob1, job_handle, job->id);
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_parse_wait(term_t job_handle, term_t linkage_list)
+ * @prologname parse_wait/2
+ *
+ * @description
+ * This predicate waits for the end of a parse job submitted by parse_submit/5, and unifies linkage_list with the list of its linkages (each one in the format of get_linkage/2)
+ * The job is then deleted, whether its parse succeeded or not. If it failed, the same lgp_api_error(sentence, Reason) exceptions as worker_parse_batch/2 are raised
+ * Other threads can submit jobs while this predicate waits (the library mutex is released meanwhile). The wait can be interrupted by a signal of the Prolog thread (thread_signal/2, Control-C): the job is then kept, and can be waited for again
+**/
+
+foreign_t pl_parse_wait(term_t job_handle, term_t linkage_list) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t       exception;
+term_t       new_linkage_list = PL_new_term_ref();
+unsigned int id;
+long         job_index;
+char         *reason;
+char         *result;
+
+  if (!get_index_from_handle(FUNCTOR_parsejob1, job_handle, &id) || find_job(id) < 0) return raise_parse_job_exception("bad_handle");
+  if (!wait_for_job(id)) {
+    if (PL_exception(0)) PL_fail; /* Interrupted by a signal: the job is left to a later parse_wait/2 */
+    if (find_job(id) < 0) return raise_parse_job_exception("bad_handle"); /* Deleted by another thread */
+    return raise_worker_exception(nb_workers == 0 ? "not_started" : "poll_failed"); /* The workers have been stopped by another thread, or poll() failed */
+  }
+  job_index = find_job(id);
+  reason = job_error_reason(job_table[job_index].status);
+  result = job_table[job_index].result;
+  job_table[job_index].result = NULL;
+  delete_job(job_index);
+
+  if (reason == NULL && !PL_chars_to_term(result, new_linkage_list)) reason = "bad_response";
+  free(result);
+  if (reason != NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "sentence",
+                  PL_CHARS, reason);
+    return PL_raise_exception(exception);
+  }
+  return PL_unify(linkage_list, new_linkage_list);
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_parse_cancel(term_t job_handle)
+ * @prologname parse_cancel/1
+ *
+ * @description
+ * This predicate deletes a parse job submitted by parse_submit/5 without waiting for its result. If the job is running, its worker is restarted
+**/
+
+foreign_t pl_parse_cancel(term_t job_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+unsigned int id;
+long         job_index;
+
+  if (!get_index_from_handle(FUNCTOR_parsejob1, job_handle, &id) || (job_index = find_job(id)) < 0) return raise_parse_job_exception("bad_handle");
+  delete_job(job_index);
+  schedule_jobs();
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_set_parse_class_limit(term_t t_priority, term_t t_max_running)
+ * @prologname set_parse_class_limit/2
+ *
+ * @description
+ * This predicate sets the largest number of parse jobs of the priority class t_priority that run at the same time (by default, all the workers can run jobs of any class)
+ * Limiting the bulk class for instance keeps some workers idle for the more urgent jobs, so that they don't have to preempt bulk jobs
+**/
+
+foreign_t pl_set_parse_class_limit(term_t t_priority, term_t t_max_running) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+int priority;
+int max_running;
+
+  if ((priority = get_parse_priority(t_priority)) < 0) return raise_parse_job_exception("bad_priority");
+  if (!PL_get_integer(t_max_running, &max_running) || max_running < 1) return raise_parse_job_exception("bad_limit");
+  parse_class_table[priority].max_running = max_running;
+  schedule_jobs();
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_get_parse_queue_statistics(term_t statistics_list)
+ * @prologname get_parse_queue_statistics/1
+ *
+ * @description
+ * This predicate unifies statistics_list with a list of Class=Measures terms, one for each priority class (interactive, normal and bulk)
+ * Measures is the list [queued=N, running=N, max_running=N, max_queued=N, completed=N, deadline_missed=N, preempted=N, stolen=N], max_queued being the deepest the queue of the class has been and stolen the number of expensive jobs of worker_parse_batch/3 run by other workers than the last one
+**/
+
+foreign_t pl_get_parse_queue_statistics(term_t statistics_list) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t      constructed_list = PL_new_term_ref(); /* Term used to store the list while constructing it */
+term_t      class_list; /* List of the measures of one class */
+term_t      new_element; /* Term used to construct each Name=Value element */
+int         priority;
+parse_class *class;
+
+  collect_worker_answers(0); /* Measures are up to date with the jobs already answered */
+  schedule_jobs();
+  PL_put_nil(constructed_list); /* Create the tail of the list (which is []), elements are then added from the last to the first one */
+  for (priority=NB_PARSE_PRIORITIES-1; priority>=0; priority--) {
+    class = &parse_class_table[priority];
+    class_list = PL_new_term_ref();
+    PL_put_nil(class_list);
+    if (!(PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "stolen", PL_LONG, (long)class->nb_stolen) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "preempted", PL_LONG, (long)class->nb_preempted) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "deadline_missed", PL_LONG, (long)class->nb_deadline_missed) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "completed", PL_LONG, (long)class->nb_completed) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "max_queued", PL_INT, (int)class->max_queued) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "max_running", PL_INT, class->max_running) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "running", PL_INT, (int)class->nb_running) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, "queued", PL_INT, (int)class->nb_queued) &&
+          PL_cons_list(class_list, new_element, class_list) &&
+          PL_unify_term(new_element = PL_new_term_ref(), PL_FUNCTOR, FUNCTOR_equals2, PL_CHARS, parse_priority_name[priority], PL_TERM, class_list) &&
+          PL_cons_list(constructed_list, new_element, constructed_list))) {
+      return raise_parse_job_exception("cant_create_info_term");
+    }
+  }
+  return PL_unify(statistics_list, constructed_list);
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_create_pipeline(term_t t_capacity, term_t t_when_full, term_t t_priority, term_t parse_options_handle, term_t pipeline_handle)
+ * @prologname create_pipeline_/5
+ *
+ * @description
+ * This predicate creates a bounded pipeline feeding the worker processes started by start_workers/2, and unifies pipeline_handle with a '$pipeline'(Id) handle on it
+ * Sentences pushed by pipeline_push/2 are tokenised and parsed by the workers as parse jobs of the priority class t_priority, and their linkages are converted into Prolog terms by pipeline_pop/2, in push order
+ * At most t_capacity sentences are in the pipeline (pushed and not yet popped), so that the memory used does not grow when the consumers fall behind. When it is full, pipeline_push/2 blocks if t_when_full is block, or fails if it is fail
+ * The sentences are parsed with the settings of parse_options_handle (as they are when the pipeline is created), or with the default ones of the workers if it is the atom default
+**/
+
+foreign_t pl_create_pipeline(term_t t_capacity, term_t t_when_full, term_t t_priority, term_t parse_options_handle, term_t pipeline_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+unsigned int            handle_index;
+opts_linked_list_object *opts_object; /* Linked object corresponding to the parse options handle */
+char                    *atom_name;
+int                     capacity;
+int                     priority;
+int                     slot;
+pipeline                *new_pipeline;
+
+  if (!PL_get_integer(t_capacity, &capacity) || capacity < 1) return raise_pipeline_exception("bad_capacity");
+  if (!PL_get_atom_chars(t_when_full, &atom_name) || (strcmp(atom_name, "block") != 0 && strcmp(atom_name, "fail") != 0)) return raise_pipeline_exception("bad_option");
+  if ((priority = get_parse_priority(t_priority)) < 0) return raise_parse_job_exception("bad_priority");
+  for (slot=0; slot<NB_PIPELINES && pipeline_table[slot].id != 0; slot++);
+  if (slot == NB_PIPELINES) return raise_pipeline_exception("too_many_pipelines");
+  new_pipeline = &pipeline_table[slot];
+  memset(new_pipeline, 0, sizeof(pipeline));
+  new_pipeline->block_when_full = (strcmp(atom_name, "block") == 0);
+  new_pipeline->priority = priority;
+  if (!(PL_get_atom_chars(parse_options_handle, &atom_name) && strcmp(atom_name, "default") == 0)) {
+    if (!get_index_from_handle(FUNCTOR_options1, parse_options_handle, &handle_index)) {
+      term_t exception=PL_new_term_ref();
+      PL_unify_term(exception,
+		    PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		    PL_CHARS, "parse_options",
+		    PL_CHARS, "bad_handle");
+      return PL_raise_exception(exception);
+    }
+    if (!get_object_from_handle_index_in_chained_list_with_exception_handling("parse_options", NULL, root_opts_list, handle_index, (generic_linked_list_object **)&opts_object)) {
+      PL_fail; /* Return the exception that has been prepared by get_object_from_handle_index_in_chained_list_with_exception_handling */
+    }
+    new_pipeline->has_options = TRUE;
+    get_worker_options(opts_object->payload, new_pipeline->options);
+  }
+  if ((new_pipeline->job_id = calloc(capacity, sizeof(unsigned int))) == NULL) return raise_pipeline_exception("not_enough_memory");
+  new_pipeline->capacity = capacity;
+  if (++last_pipeline_id > INT_MAX) last_pipeline_id = 1; /* Identifiers must fit in the integer of the handle */
+  new_pipeline->id = last_pipeline_id;
+  return unify_handle_with_index(FUNCTOR_pipeline1, pipeline_handle, new_pipeline->id);
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+#ifdef LGP_WORKERS_SUPPORTED
+/**
+ * @name static int wait_for_pipeline_change(void)
+ *
+ * @description
+ * This function waits until a sentence enters or leaves a pipeline, or a pipeline is closed or deleted, for at most SCHEDULER_POLL_INTERVAL ms, without holding the library mutex (however many times the calling thread holds it)
+ * The signals of the calling Prolog thread are handled after each wait, so that a blocked producer or consumer can be interrupted (thread_signal/2, Control-C). FALSE is returned if a signal handler raised an exception, that the caller must let Prolog raise
+**/
+
+static int wait_for_pipeline_change(void) {
+
+struct timespec deadline;
+int             nb_nested_locks;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += SCHEDULER_POLL_INTERVAL * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+  nb_nested_locks = release_nested_library_locks();
+  pthread_cond_timedwait(&pipeline_changed, &lgp_library_mutex, &deadline); /* The last lock of the library mutex is released while waiting */
+  restore_nested_library_locks(nb_nested_locks);
+  return (PL_handle_signals() >= 0);
+}
+#endif
+
+
+/**
+ * @name foreign_t pl_pipeline_push(term_t pipeline_handle, term_t t_input_sentence)
+ * @prologname pipeline_push/2
+ *
+ * @description
+ * This predicate pushes a sentence (an atom, a string or a code list) into a pipeline created by create_pipeline/2. Its parse is submitted to the workers right away
+ * If the pipeline is full, this predicate waits (without holding the library mutex) until a consumer pops a sentence, or fails at once if the pipeline has been created with when_full(fail). The wait can be interrupted by a signal of the Prolog thread (see wait_for_pipeline_change())
+**/
+
+foreign_t pl_pipeline_push(term_t pipeline_handle, term_t t_input_sentence) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t       exception;
+unsigned int id;
+int          slot;
+pipeline     *target;
+char         *text; /* Text of the sentence, given to its job */
+size_t       text_length;
+long         job_index;
+
+  if (!get_index_from_handle(FUNCTOR_pipeline1, pipeline_handle, &id) || (slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle");
+  while (pipeline_table[slot].nb_jobs + pipeline_table[slot].nb_popping >= pipeline_table[slot].capacity) { /* Back-pressure */
+    if (pipeline_table[slot].closed) break;
+    if (!pipeline_table[slot].block_when_full) PL_fail;
+    if (!wait_for_pipeline_change()) PL_fail; /* Interrupted: raise the exception of the signal handler */
+    if ((slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle"); /* Deleted meanwhile */
+  }
+  target = &pipeline_table[slot];
+  if (target->closed) return raise_pipeline_exception("closed");
+  if (nb_workers == 0) return raise_worker_exception("not_started");
+  if (!PL_get_nchars(t_input_sentence, &text_length, &text, CVT_ATOM|CVT_STRING|CVT_LIST|BUF_MALLOC)) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+		  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+		  PL_CHARS, "sentence",
+		  PL_CHARS, "instanciation_fault");
+    return PL_raise_exception(exception);
+  }
+  if ((job_index = create_job(text, text_length, target->priority, HUGE_VAL)) < 0) {
+    PL_free(text);
+    return raise_pipeline_exception("not_enough_memory");
+  }
+  job_table[job_index].has_options = target->has_options;
+  memcpy(job_table[job_index].options, target->options, sizeof(target->options));
+  target->job_id[(target->head + target->nb_jobs) % target->capacity] = job_table[job_index].id;
+  target->nb_jobs++;
+  collect_worker_answers(0); /* Free the workers that are done before choosing the next jobs */
+  schedule_jobs();
+  pthread_cond_broadcast(&pipeline_changed); /* Wake up the consumers waiting for a sentence */
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_pipeline_pop(term_t pipeline_handle, term_t linkage_list)
+ * @prologname pipeline_pop/2
+ *
+ * @description
+ * This predicate takes the oldest sentence of a pipeline, waits for the end of its parse and unifies linkage_list with the list of its linkages (each one in the format of get_linkage/2)
+ * If the pipeline is empty, it waits for a producer to push a sentence, or fails if the pipeline has been closed by close_pipeline/1. This wait, as well as the wait for the parse, can be interrupted by a signal as in pipeline_push/2 (the sentence is then dropped)
+ * If the parse of the sentence failed, the sentence is removed from the pipeline and the same lgp_api_error(sentence, Reason) exceptions as parse_wait/2 are raised
+ * Several consumers can pop from the same pipeline: each one gets the sentences in push order, the space of a sentence being given back to the producers once its parse has been collected
+**/
+
+foreign_t pl_pipeline_pop(term_t pipeline_handle, term_t linkage_list) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+term_t       exception;
+term_t       new_linkage_list = PL_new_term_ref();
+unsigned int id;
+unsigned int job_id;
+int          slot;
+pipeline     *source;
+long         job_index;
+int          job_done;
+char         *reason;
+char         *result = NULL;
+
+  if (!get_index_from_handle(FUNCTOR_pipeline1, pipeline_handle, &id) || (slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle");
+  while (pipeline_table[slot].nb_jobs == 0) {
+    if (pipeline_table[slot].closed) PL_fail; /* End of the stream */
+    if (!wait_for_pipeline_change()) PL_fail; /* See pl_pipeline_push() */
+    if ((slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle");
+  }
+  source = &pipeline_table[slot];
+  job_id = source->job_id[source->head];
+  source->head = (source->head + 1) % source->capacity;
+  source->nb_jobs--;
+  source->nb_popping++; /* The sentence keeps its space until its parse is collected */
+
+  job_done = wait_for_job(job_id); /* The library mutex is released while waiting */
+  if ((slot = find_pipeline(id)) >= 0) pipeline_table[slot].nb_popping--;
+  pthread_cond_broadcast(&pipeline_changed); /* Wake up the producers waiting for space */
+  if ((job_index = find_job(job_id)) >= 0 && (slot < 0 || !job_done)) delete_job(job_index); /* The sentence is lost if the pipeline has been deleted or the wait interrupted */
+  if (slot < 0 || job_index < 0) return raise_pipeline_exception("bad_handle"); /* The pipeline has been deleted meanwhile */
+  if (!job_done) {
+    if (PL_exception(0)) PL_fail; /* Interrupted by a signal (see pl_pipeline_push()) */
+    return raise_worker_exception(nb_workers == 0 ? "not_started" : "poll_failed"); /* The workers have been stopped by another thread, or poll() failed */
+  }
+  reason = job_error_reason(job_table[job_index].status);
+  result = job_table[job_index].result;
+  job_table[job_index].result = NULL;
+  delete_job(job_index);
+
+  if (reason == NULL && !PL_chars_to_term(result, new_linkage_list)) reason = "bad_response"; /* Conversion stage, done by the consumer */
+  free(result);
+  if (reason != NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "sentence",
+                  PL_CHARS, reason);
+    return PL_raise_exception(exception);
+  }
+  return PL_unify(linkage_list, new_linkage_list);
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_close_pipeline(term_t pipeline_handle)
+ * @prologname close_pipeline/1
+ *
+ * @description
+ * This predicate marks the end of the stream of a pipeline: pipeline_push/2 raises lgp_api_error(pipeline, closed) from now on, and pipeline_pop/2 fails once the sentences already pushed have been popped
+**/
+
+foreign_t pl_close_pipeline(term_t pipeline_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+unsigned int id;
+int          slot;
+
+  if (!get_index_from_handle(FUNCTOR_pipeline1, pipeline_handle, &id) || (slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle");
+  pipeline_table[slot].closed = TRUE;
+  pthread_cond_broadcast(&pipeline_changed); /* Consumers waiting on an empty pipeline must fail */
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name foreign_t pl_delete_pipeline(term_t pipeline_handle)
+ * @prologname delete_pipeline/1
+ *
+ * @description
+ * This predicate deletes a pipeline and the parse jobs of the sentences it still contains. Threads waiting on it get lgp_api_error(pipeline, bad_handle)
+**/
+
+foreign_t pl_delete_pipeline(term_t pipeline_handle) {
+
+#ifdef LGP_WORKERS_SUPPORTED
+unsigned int id;
+int          slot;
+
+  if (!get_index_from_handle(FUNCTOR_pipeline1, pipeline_handle, &id) || (slot = find_pipeline(id)) < 0) return raise_pipeline_exception("bad_handle");
+  delete_pipeline_slot(slot);
+  schedule_jobs();
+  PL_succeed;
+#else
+  return raise_worker_exception("not_supported");
+#endif
+}
+
+
+/**
+ * @name main(int argc, char **argv)
+ *
+ * @description
+ * This main function is there to give a WinMain@16 label to CygWin. It is not used during the DLL normal use
+**/
+
+int main(int argc, char **argv) {
+  return 0;
+}
+
+
+#if (defined(__MINGW32__) || defined(__MINGW64__) || defined(WIN32) || defined(_WIN32))
+/**
+ * @name lgp_init_dll(HANDLE h, DWORD reason, void *foo)
+ *
+ * @description
+ * This function is the entry point of the DLL. It is started when the DLL is loaded in memory and does... nothing!
+**/
+
+int WINAPI lgp_init_dll(HANDLE h, DWORD reason, void *foo) {
+  return 1;
+}
+#endif
+
+
+/* Definition of the synchronized version of every foreign predicate registered in install_lgp() below */
+SYNCHRONIZED_FOREIGN_5(pl_create_dictionary)
+SYNCHRONIZED_FOREIGN_1(pl_reload_dictionary)
+SYNCHRONIZED_FOREIGN_1(pl_delete_dictionary)
+SYNCHRONIZED_FOREIGN_0(pl_delete_all_dictionaries)
+SYNCHRONIZED_FOREIGN_1(pl_get_nb_dictionaries)
+SYNCHRONIZED_FOREIGN_2(pl_get_handles_nb_references_dictionaries)
+SYNCHRONIZED_FOREIGN_1(pl_create_parse_options)
+SYNCHRONIZED_FOREIGN_1(pl_delete_parse_options)
+SYNCHRONIZED_FOREIGN_0(pl_delete_all_parse_options)
+SYNCHRONIZED_FOREIGN_1(pl_get_nb_parse_options)
+SYNCHRONIZED_FOREIGN_2(pl_get_handles_nb_references_parse_options)
+SYNCHRONIZED_FOREIGN_3(pl_create_linkage_set)
+SYNCHRONIZED_FOREIGN_3(pl_reparse_linkage_set)
+SYNCHRONIZED_FOREIGN_2(pl_copy_linkage_set_parse_options)
+SYNCHRONIZED_FOREIGN_1(pl_delete_linkage_set)
+SYNCHRONIZED_FOREIGN_0(pl_delete_all_linkage_sets)
+SYNCHRONIZED_FOREIGN_1(pl_get_nb_linkage_sets)
+SYNCHRONIZED_FOREIGN_2(pl_get_handles_nb_references_linkage_sets)
+SYNCHRONIZED_FOREIGN_2(pl_get_num_linkages)
+SYNCHRONIZED_FOREIGN_2(pl_get_parameters_for_linkage_set)
+SYNCHRONIZED_FOREIGN_2(pl_get_linkage_set_statistics)
+SYNCHRONIZED_FOREIGN_3(pl_sentence_accepts)
+SYNCHRONIZED_FOREIGN_3(pl_estimate_parse_cost)
+SYNCHRONIZED_FOREIGN_2(pl_begin_parse_session)
+SYNCHRONIZED_FOREIGN_2(pl_end_parse_session)
+SYNCHRONIZED_FOREIGN_2(pl_start_workers)
+SYNCHRONIZED_FOREIGN_0(pl_stop_workers)
+SYNCHRONIZED_FOREIGN_1(pl_get_worker_pids)
+SYNCHRONIZED_FOREIGN_4(pl_worker_parse_batch)
+SYNCHRONIZED_FOREIGN_5(pl_parse_submit)
+SYNCHRONIZED_FOREIGN_2(pl_parse_wait)
+SYNCHRONIZED_FOREIGN_1(pl_parse_cancel)
+SYNCHRONIZED_FOREIGN_2(pl_set_parse_class_limit)
+SYNCHRONIZED_FOREIGN_1(pl_get_parse_queue_statistics)
+SYNCHRONIZED_FOREIGN_5(pl_create_pipeline)
+SYNCHRONIZED_FOREIGN_2(pl_pipeline_push)
+SYNCHRONIZED_FOREIGN_2(pl_pipeline_pop)
+SYNCHRONIZED_FOREIGN_1(pl_close_pipeline)
+SYNCHRONIZED_FOREIGN_1(pl_delete_pipeline)
+SYNCHRONIZED_FOREIGN_3(pl_create_sentence)
+SYNCHRONIZED_FOREIGN_1(pl_delete_sentence)
+SYNCHRONIZED_FOREIGN_0(pl_delete_all_sentences)
+SYNCHRONIZED_FOREIGN_1(pl_get_nb_sentences)
+SYNCHRONIZED_FOREIGN_2(pl_get_handles_nb_references_sentences)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_linkage_limit)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_linkage_limit)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_disjunct_cost)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_disjunct_cost)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_min_null_count)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_min_null_count)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_max_null_count)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_max_null_count)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_null_block)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_null_block)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_islands_ok)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_islands_ok)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_short_length)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_short_length)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_all_short_connectors)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_all_short_connectors)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_max_parse_time)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_max_parse_time)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_max_memory)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_max_memory)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_max_sentence_length)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_max_sentence_length)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_batch_mode)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_batch_mode)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_panic_mode)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_panic_mode)
+SYNCHRONIZED_FOREIGN_2(pl_po_set_allow_null)
+SYNCHRONIZED_FOREIGN_2(pl_po_get_allow_null)
+SYNCHRONIZED_FOREIGN_1(pl_get_max_sentence)
+SYNCHRONIZED_FOREIGN_1(pl_enable_panic_on_parse_options)
+SYNCHRONIZED_FOREIGN_1(pl_disable_panic_on_parse_options)
+SYNCHRONIZED_NONDET_FOREIGN_2(pl_get_linkage)
+SYNCHRONIZED_NONDET_FOREIGN_3(pl_get_linkage_with_options)
+SYNCHRONIZED_FOREIGN_5(pl_get_linkages)
+SYNCHRONIZED_FOREIGN_2(pl_connector_label)
+SYNCHRONIZED_FOREIGN_4(pl_get_best_linkages)
+
+
+/**
+ * @name install_lgp()
+ *
+ * @description
+ * This is the initialisation routine for this foreign language library
+ * This function has to be called by load_foreign_library/2 from the Prolog side in order to register the predicates implemented here as C code
+**/
+
+install_t install_lgp() {
+
+term_t exception; /* Handle for a possible exception */
+
+  lgp_library_mutex_init(); /* Must be done before any predicate can be called */
+
+  PL_register_foreign("create_dictionary", 5, pl_create_dictionary_synchronized, 0);
+  PL_register_foreign("reload_dictionary", 1, pl_reload_dictionary_synchronized, 0);
+  PL_register_foreign("delete_dictionary", 1, pl_delete_dictionary_synchronized, 0);
+  PL_register_foreign("delete_all_dictionaries", 0, pl_delete_all_dictionaries_synchronized, 0);
+  PL_register_foreign("get_nb_dictionaries", 1, pl_get_nb_dictionaries_synchronized, 0);
+  PL_register_foreign("get_handles_nb_references_dictionaries", 2, pl_get_handles_nb_references_dictionaries_synchronized, 0);
+
+  PL_register_foreign("create_parse_options_", 1, pl_create_parse_options_synchronized, 0);
+  PL_register_foreign("delete_parse_options", 1, pl_delete_parse_options_synchronized, 0);
+  PL_register_foreign("delete_all_parse_options", 0, pl_delete_all_parse_options_synchronized, 0);
+  PL_register_foreign("get_nb_parse_options", 1, pl_get_nb_parse_options_synchronized, 0);
+  PL_register_foreign("get_handles_nb_references_parse_options", 2, pl_get_handles_nb_references_parse_options_synchronized, 0);
+
+  PL_register_foreign("create_linkage_set", 3, pl_create_linkage_set_synchronized, 0);
+  PL_register_foreign("reparse_linkage_set_", 3, pl_reparse_linkage_set_synchronized, 0);
+  PL_register_foreign("copy_linkage_set_parse_options_", 2, pl_copy_linkage_set_parse_options_synchronized, 0);
+  PL_register_foreign("delete_linkage_set", 1, pl_delete_linkage_set_synchronized, 0);
+  PL_register_foreign("delete_all_linkage_sets", 0, pl_delete_all_linkage_sets_synchronized, 0);
+  PL_register_foreign("get_nb_linkage_sets", 1, pl_get_nb_linkage_sets_synchronized, 0);
+  PL_register_foreign("get_handles_nb_references_linkage_sets", 2, pl_get_handles_nb_references_linkage_sets_synchronized, 0);
+
+  PL_register_foreign("get_num_linkages", 2, pl_get_num_linkages_synchronized, 0);
+  PL_register_foreign("get_parameters_for_linkage_set", 2, pl_get_parameters_for_linkage_set_synchronized, 0);
+  PL_register_foreign("get_linkage_set_statistics", 2, pl_get_linkage_set_statistics_synchronized, 0);
+  PL_register_foreign("sentence_accepts", 3, pl_sentence_accepts_synchronized, 0);
+  PL_register_foreign("estimate_parse_cost", 3, pl_estimate_parse_cost_synchronized, 0);
+
+  PL_register_foreign("begin_parse_session_", 2, pl_begin_parse_session_synchronized, 0);
+  PL_register_foreign("end_parse_session_", 2, pl_end_parse_session_synchronized, 0);
+
+  PL_register_foreign("start_workers", 2, pl_start_workers_synchronized, 0);
+  PL_register_foreign("stop_workers", 0, pl_stop_workers_synchronized, 0);
+  PL_register_foreign("get_worker_pids", 1, pl_get_worker_pids_synchronized, 0);
+  PL_register_foreign("worker_parse_batch_", 4, pl_worker_parse_batch_synchronized, 0);
+  PL_register_foreign("parse_submit", 5, pl_parse_submit_synchronized, 0);
+  PL_register_foreign("parse_wait", 2, pl_parse_wait_synchronized, 0);
+  PL_register_foreign("parse_cancel", 1, pl_parse_cancel_synchronized, 0);
+  PL_register_foreign("set_parse_class_limit", 2, pl_set_parse_class_limit_synchronized, 0);
+  PL_register_foreign("get_parse_queue_statistics", 1, pl_get_parse_queue_statistics_synchronized, 0);
+  PL_register_foreign("create_pipeline_", 5, pl_create_pipeline_synchronized, 0);
+  PL_register_foreign("pipeline_push", 2, pl_pipeline_push_synchronized, 0);
+  PL_register_foreign("pipeline_pop", 2, pl_pipeline_pop_synchronized, 0);
+  PL_register_foreign("close_pipeline", 1, pl_close_pipeline_synchronized, 0);
+  PL_register_foreign("delete_pipeline", 1, pl_delete_pipeline_synchronized, 0);
+
+  PL_register_foreign("create_sentence", 3, pl_create_sentence_synchronized, 0);
+  PL_register_foreign("delete_sentence", 1, pl_delete_sentence_synchronized, 0);
+  PL_register_foreign("delete_all_sentences", 0, pl_delete_all_sentences_synchronized, 0);
+  PL_register_foreign("get_nb_sentences", 1, pl_get_nb_sentences_synchronized, 0);
+  PL_register_foreign("get_handles_nb_references_sentences", 2, pl_get_handles_nb_references_sentences_synchronized, 0);
+
+  PL_register_foreign("po_set_linkage_limit_", 2, pl_po_set_linkage_limit_synchronized, 0);
+  PL_register_foreign("po_get_linkage_limit_", 2, pl_po_get_linkage_limit_synchronized, 0);
+  PL_register_foreign("po_set_disjunct_cost_", 2, pl_po_set_disjunct_cost_synchronized, 0);
+  PL_register_foreign("po_get_disjunct_cost_", 2, pl_po_get_disjunct_cost_synchronized, 0);
+  PL_register_foreign("po_set_min_null_count_", 2, pl_po_set_min_null_count_synchronized, 0);
+  PL_register_foreign("po_get_min_null_count_", 2, pl_po_get_min_null_count_synchronized, 0);
+  PL_register_foreign("po_set_max_null_count_", 2, pl_po_set_max_null_count_synchronized, 0);
+  PL_register_foreign("po_get_max_null_count_", 2, pl_po_get_max_null_count_synchronized, 0);
+  PL_register_foreign("po_set_null_block_", 2, pl_po_set_null_block_synchronized, 0);
+  PL_register_foreign("po_get_null_block_", 2, pl_po_get_null_block_synchronized, 0);
+  PL_register_foreign("po_set_islands_ok_", 2, pl_po_set_islands_ok_synchronized, 0);
+  PL_register_foreign("po_get_islands_ok_", 2, pl_po_get_islands_ok_synchronized, 0);
+  PL_register_foreign("po_set_short_length_", 2, pl_po_set_short_length_synchronized, 0);
+  PL_register_foreign("po_get_short_length_", 2, pl_po_get_short_length_synchronized, 0);
+  PL_register_foreign("po_set_all_short_connectors_", 2, pl_po_set_all_short_connectors_synchronized, 0);
+  PL_register_foreign("po_get_all_short_connectors_", 2, pl_po_get_all_short_connectors_synchronized, 0);
+  PL_register_foreign("po_set_max_parse_time_", 2, pl_po_set_max_parse_time_synchronized, 0);
+  PL_register_foreign("po_get_max_parse_time_", 2, pl_po_get_max_parse_time_synchronized, 0);
+  PL_register_foreign("po_set_max_memory_", 2, pl_po_set_max_memory_synchronized, 0);
+  PL_register_foreign("po_get_max_memory_", 2, pl_po_get_max_memory_synchronized, 0);
+  PL_register_foreign("po_set_max_sentence_length_", 2, pl_po_set_max_sentence_length_synchronized, 0);
+  PL_register_foreign("po_get_max_sentence_length_", 2, pl_po_get_max_sentence_length_synchronized, 0);
+  PL_register_foreign("po_set_batch_mode_", 2, pl_po_set_batch_mode_synchronized, 0);
+  PL_register_foreign("po_get_batch_mode_", 2, pl_po_get_batch_mode_synchronized, 0);
+  PL_register_foreign("po_set_panic_mode_", 2, pl_po_set_panic_mode_synchronized, 0);
+  PL_register_foreign("po_get_panic_mode_", 2, pl_po_get_panic_mode_synchronized, 0);
+  PL_register_foreign("po_set_allow_null_", 2, pl_po_set_allow_null_synchronized, 0);
+  PL_register_foreign("po_get_allow_null_", 2, pl_po_get_allow_null_synchronized, 0);
+
+  PL_register_foreign("get_max_sentence", 1, pl_get_max_sentence_synchronized, 0);
+  PL_register_foreign("enable_panic_on_parse_options", 1, pl_enable_panic_on_parse_options_synchronized, 0);
+  PL_register_foreign("disable_panic_on_parse_options", 1, pl_disable_panic_on_parse_options_synchronized, 0);
+
+  PL_register_foreign("get_linkage", 2, pl_get_linkage_synchronized, PL_FA_NONDETERMINISTIC);
+  PL_register_foreign("get_linkage", 3, pl_get_linkage_with_options_synchronized, PL_FA_NONDETERMINISTIC);
+  PL_register_foreign("get_linkages", 5, pl_get_linkages_synchronized, 0);
+  PL_register_foreign("connector_label", 2, pl_connector_label_synchronized, 0);
+  PL_register_foreign("get_best_linkages", 4, pl_get_best_linkages_synchronized, 0);
+
+  FUNCTOR_dictionary1 = PL_new_functor(PL_new_atom("$dictionary"), 1); /* Create a '$dictionary'/1 functor for dictionary table handling */
+  FUNCTOR_options1 = PL_new_functor(PL_new_atom("$options"), 1); /* Create a '$options'/1 functor for parse options table handling */
+  FUNCTOR_linkageset1 = PL_new_functor(PL_new_atom("$linkageset"), 1); /* Create a '$linkage'/1 functor for parse options table handling */
+  FUNCTOR_sentence1 = PL_new_functor(PL_new_atom("$sentence"), 1); /* Create a '$sentence'/1 functor for parse options table handling */
+  FUNCTOR_parsejob1 = PL_new_functor(PL_new_atom("$parse_job"), 1); /* Create a '$parse_job'/1 functor for parse job handling */
+  FUNCTOR_pipeline1 = PL_new_functor(PL_new_atom("$pipeline"), 1); /* Create a '$pipeline'/1 functor for pipeline handling */
+
+  FUNCTOR_list2 = PL_new_functor(PL_new_atom("."), 2); /* Create the list functor (./2) */
+  FUNCTOR_equals2 = PL_new_functor(PL_new_atom("="), 2); /* Create the =/2 functor */
+  FUNCTOR_link2 = PL_new_functor(PL_new_atom("link"), 2); /* Create the link/2 functor */
+  FUNCTOR_hyphen2 = PL_new_functor(PL_new_atom("-"), 2); /* Create the -/2 functor */
+  FUNCTOR_connection3 = PL_new_functor(PL_new_atom("connection"), 3); /* Create the connection/3 functor */
+  FUNCTOR_w3 = PL_new_functor(PL_new_atom("w"), 3); /* Create the w/3 functor */
+  FUNCTOR_word_format1 = PL_new_functor(PL_new_atom("word_format"), 1); /* Create the word_format/1 functor */
+  FUNCTOR_connector_format1 = PL_new_functor(PL_new_atom("connector_format"), 1); /* Create the connector_format/1 functor */
+  FUNCTOR_format1 = PL_new_functor(PL_new_atom("format"), 1); /* Create the format/1 functor */
+  FUNCTOR_fields1 = PL_new_functor(PL_new_atom("fields"), 1); /* Create the fields/1 functor */
+  FUNCTOR_compact2 = PL_new_functor(PL_new_atom("compact"), 2); /* Create the compact/2 functor */
+  FUNCTOR_l4 = PL_new_functor(PL_new_atom("l"), 4); /* Create the l/4 functor */
+
+/* We test that root_dict_list is NULL here (it has been initialised with this value in its declaration above) */
+  if (root_dict_list != NULL) {
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "dictionary",
+                  PL_CHARS, "list_corrupted");
+    PL_raise_exception(exception);
+    return;
+  }
+
+  root_dict_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of dictionaries with a generic object type */
+  if (root_dict_list == NULL) { /* Allocation failed */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "dictionary",
+                  PL_CHARS, "not_enough_memory");
+    PL_raise_exception(exception);
+    return;
+  }
+  root_dict_list->next=NULL; /* No first element attached to the root: the list is empty */
+  root_dict_list->nb_jumped_index=0; /* No jumped free space */
+  root_dict_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
+  root_dict_list->session=0;
+
+  root_opts_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of parse options with a generic object type */
+  if (root_opts_list == NULL) { /* Allocation failed */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "parse_options",
+                  PL_CHARS, "not_enough_memory");
+    PL_raise_exception(exception);
+    return;
+  }
+  root_opts_list->next=NULL; /* No first element attached to the root: the list is empty */
+  root_opts_list->nb_jumped_index=0; /* No jumped free space */
+  root_opts_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
+  root_opts_list->session=0;
+
+  root_link_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of linkage sets with a generic object type */
+  if (root_link_list == NULL) { /* Allocation failed */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "linkage_set",
+                  PL_CHARS, "not_enough_memory");
+    PL_raise_exception(exception);
+    return;
+  }
+  root_link_list->next=NULL; /* No first element attached to the root: the list is empty */
+  root_link_list->nb_jumped_index=0; /* No jumped free space */
+  root_link_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
+  root_link_list->session=0;
+
+  root_sent_list=malloc(sizeof(generic_linked_list_object)); /* Allocate the root of sentences with a generic object type */
+  if (root_sent_list == NULL) { /* Allocation failed */
+    exception=PL_new_term_ref();
+    PL_unify_term(exception,
+                  PL_FUNCTOR, PL_new_functor(PL_new_atom("lgp_api_error"), 2),
+                  PL_CHARS, "sentence",
+                  PL_CHARS, "not_enough_memory");
+    PL_raise_exception(exception);
+    return;
+  }
+  root_sent_list->next=NULL; /* No first element attached to the root: the list is empty */
+  root_sent_list->nb_jumped_index=0; /* No jumped free space */
+  root_sent_list->count_references=((unsigned int)-1)>>1; /* Make sure that the root will never be deleted */
+  root_sent_list->session=0;
+}
+
+
+/**
+ * @name uninstall_lgp()
+ *
+ * @description
+ * This is the uninstallation routine for this foreign language library
+ * This function is be called by unload_foreign_library/2 from the Prolog side in order to free the memory used by the DLL
 **/
 
 install_t uninstall_lgp() {
+
+#ifdef LGP_WORKERS_SUPPORTED
+int i;
+#endif
+
+  lgp_library_lock();
+  pl_stop_workers(); /* Worker processes hold a reference on their dictionary */
+#ifdef LGP_WORKERS_SUPPORTED
+  for (i=0; i<NB_PIPELINES; i++)
+    if (pipeline_table[i].id != 0) delete_pipeline_slot(i);
+  delete_all_jobs(); /* Jobs not collected by parse_wait/2 */
+#endif
   pl_delete_all_linkage_sets(); /* These functions have to be called in this precise order to avoid signal 11 exceptions (segmentation fault) */
   pl_delete_all_sentences(); /* The linkage set uses the sentence object and must therefore be deleted before */
   pl_delete_all_parse_options();
   pl_delete_all_dictionaries(); /* The sentence object uses the dictionary one and must therefore be deleted before */
+  empty_get_linkage_context_pool();
+  delete_compiled_connectors();
+  lgp_library_unlock();
 }
@@ -1,4 +1,6 @@
 :- use_module(lgp_local).
+:- use_module(lgp_remote, []).
+:- use_module(library(process)).
 
 go:-
 	set_prolog_flag(failure_number, 0),
@@ -64,7 +66,10 @@ go(Family, Name, Parms, Indent):-
 create_parms_dictionary(['4.0.dict', '4.0.knowledge', '4.0.constituent-knowledge', '4.0.affix']).
 create_parms_sentence_unique_linkage('The software is now fully installed').
 create_parms_sentence_multiple_linkages('This is the first recorded sentence', 3).
+create_parms_long_sentence('The people who said that the software was installed yesterday believe that the computer which the engineers bought last week will be running the new programs that the students wrote for the class').
 create_parms_parse_options_normal([disjunct_cost=2, min_null_count=0, max_null_count=0, linkage_limit=100, max_parse_time=10, max_memory=128000000]).
+create_parms_sentence_null_links('The software is is now fully installed').
+create_parms_parse_options_null_links([disjunct_cost=2, min_null_count=0, max_null_count=250, linkage_limit=100, max_parse_time=10, max_memory=128000000]).
 create_parms_parse_options_panic([disjunct_cost=3, min_null_count=1, max_null_count=250, linkage_limit=100, max_parse_time=10, max_memory=128000000]).
 
 :- discontiguous scheduled_test_name/1.
@@ -101,6 +106,125 @@ scheduled_test_name('Normal use', 'sample creation of two linkage sets', [create
 	create_parms_sentence_multiple_linkages(Create_parms_sent2, Number_linkage),
 	create_parms_parse_options_normal(Create_parms_opts),
 	create_parms_parse_options_panic(Create_parms_opts_panic).
+scheduled_test_name('Normal use', 'get all linkages for one sentence', [create_parms_dict=Create_parms_dict,
+									create_parms_sent=Create_parms_sent,
+									create_parms_opts=Create_parms_opts,
+									num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Normal use', 'get linkage with string output format', [create_parms_dict=Create_parms_dict,
+									    create_parms_sent=Create_parms_sent,
+									    create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Normal use', 'get linkage in compact format', [create_parms_dict=Create_parms_dict,
+								    create_parms_sent=Create_parms_sent,
+								    create_parms_opts=Create_parms_opts,
+								    num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Normal use', 'get best linkages', [create_parms_dict=Create_parms_dict,
+							create_parms_sent=Create_parms_sent,
+							create_parms_opts=Create_parms_opts,
+							num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Normal use', 'get linkage with field projection', [create_parms_dict=Create_parms_dict,
+									  create_parms_sent=Create_parms_sent,
+									  create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Normal use', 'parse without post-processing', [create_parms_sent=Create_parms_sent,
+								    create_parms_opts=Create_parms_opts]):-
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'same links with and without post-processing knowledge', [create_parms_dict=Create_parms_dict,
+											       create_parms_sent=Create_parms_sent,
+											       create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'parse with worker processes', [create_parms_dict=Create_parms_dict,
+								  create_parms_sent=Create_parms_sent,
+								  create_parms_long_sent=Create_parms_long_sent,
+								  create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_long_sentence(Create_parms_long_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'restart of a crashed worker', [create_parms_dict=Create_parms_dict,
+								  create_parms_sent=Create_parms_sent,
+								  create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'parse on an lgp-server', [create_parms_dict=Create_parms_dict,
+							       create_parms_sent=Create_parms_sent,
+							       create_parms_opts=Create_parms_opts,
+							       nb_sentences=10000]):- % The requests of the batch are larger than the socket buffers
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'stealing of expensive batch sentences', [create_parms_dict=Create_parms_dict,
+									     create_parms_long_sent=Create_parms_long_sent]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_long_sentence(Create_parms_long_sent).
+
+scheduled_test_name('Normal use', 'parse jobs with priorities', [create_parms_dict=Create_parms_dict,
+								 create_parms_sent=Create_parms_sent,
+								 create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'preemption of a bulk job', [create_parms_dict=Create_parms_dict,
+							       create_parms_sent=Create_parms_sent,
+							       create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'parse through a pipeline', [create_parms_dict=Create_parms_dict,
+								create_parms_sent=Create_parms_sent]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent).
+
+scheduled_test_name('Normal use', 'blocking push on a full pipeline', [create_parms_dict=Create_parms_dict,
+									create_parms_sent=Create_parms_sent]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent).
+
+scheduled_test_name('Normal use', 'interrupted waits for the workers', [create_parms_dict=Create_parms_dict,
+									 create_parms_sent=Create_parms_sent,
+									 create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'concurrent parses from several threads', [create_parms_dict=Create_parms_dict,
+									      create_parms_sent=Create_parms_sent,
+									      create_parms_opts=Create_parms_opts,
+									      num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Normal use', 'parse session', [create_parms_dict=Create_parms_dict,
+						    create_parms_sent=Create_parms_sent,
+						    create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
 
 scheduled_test_name('Foreign', 'unload/reload', []):-
 	unload_foreign_library(lgp),
@@ -112,6 +236,12 @@ scheduled_test_name('Dictionary', 'addition of a reference', [create_parms_dict=
 							      create_parms_sent=Create_parms_sent]):-
 	create_parms_dictionary(Create_parms_dict),
 	create_parms_sentence_unique_linkage(Create_parms_sent).
+scheduled_test_name('Dictionary', 'reload', [create_parms_dict=Create_parms_dict,
+					     create_parms_sent=Create_parms_sent,
+					     create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
 scheduled_test_name('Dictionary', 'deletion of non-existing handle', [create_parms_dict=Create_parms_dict,
 								      handle('Dictionary')=_Handle_dict]):-
 	create_parms_dictionary(Create_parms_dict).
@@ -140,6 +270,12 @@ scheduled_test_name('Sentence', 'addition of a reference', [create_parms_dict=Cr
 	create_parms_dictionary(Create_parms_dict),
 	create_parms_sentence_unique_linkage(Create_parms_sent),
 	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Sentence', 'creation from string and code list', [create_parms_dict=Create_parms_dict,
+								      create_parms_sent=Create_parms_sent,
+								      create_parms_opts=Create_parms_opts]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_unique_linkage(Create_parms_sent),
+	create_parms_parse_options_normal(Create_parms_opts).
 scheduled_test_name('Sentence', 'deletion of non-existing handle', [create_parms_dict=Create_parms_dict,
 								    create_parms_sent=Create_parms_sent,
 								    handle('Dictionary')=_Handle_dict,
@@ -178,7 +314,95 @@ scheduled_test_name('Linkage Set', 'deletion of linkage set object before cut of
 	create_parms_dictionary(Create_parms_dict),
 	create_parms_sentence_multiple_linkages(Create_parms_sent, _Number_linkage),
 	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'statistics', [create_parms_dict=Create_parms_dict,
+						  create_parms_sent=Create_parms_sent,
+						  create_parms_opts=Create_parms_opts,
+						  handle('Dictionary')=_Handle_dict,
+						  handle('Sentence')=_Handle_sent,
+						  handle('Parse Options')=_Handle_opts,
+						  handle('Linkage Set')=_Handle_link,
+						  num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'sentence acceptance', [create_parms_dict=Create_parms_dict,
+							   create_parms_sent=Create_parms_sent,
+							   create_parms_opts=Create_parms_opts,
+							   handle('Dictionary')=_Handle_dict,
+							   handle('Sentence')=_Handle_sent,
+							   handle('Parse Options')=_Handle_opts,
+							   handle('Linkage Set')=_Handle_link,
+							   num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'memory budget', [create_parms_dict=Create_parms_dict,
+						     create_parms_sent=Create_parms_sent,
+						     create_parms_opts=Create_parms_opts,
+						     handle('Dictionary')=_Handle_dict,
+						     handle('Sentence')=_Handle_sent,
+						     handle('Parse Options')=_Handle_opts,
+						     handle('Linkage Set')=_Handle_link,
+						     num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'parse cost estimate', [create_parms_dict=Create_parms_dict,
+							   create_parms_sent=Create_parms_sent,
+							   create_parms_opts=Create_parms_opts,
+							   handle('Dictionary')=_Handle_dict,
+							   handle('Sentence')=_Handle_sent,
+							   handle('Parse Options')=_Handle_opts,
+							   handle('Linkage Set')=_Handle_link,
+							   num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
 
+scheduled_test_name('Linkage Set', 'nested get_linkage calls', [create_parms_dict=Create_parms_dict,
+							       create_parms_sent=Create_parms_sent,
+							       create_parms_opts=Create_parms_opts,
+							       handle('Dictionary')=_Handle_dict,
+							       handle('Sentence')=_Handle_sent,
+							       handle('Parse Options')=_Handle_opts,
+							       handle('Linkage Set')=_Handle_link,
+							       num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+
+scheduled_test_name('Linkage Set', 'reparse with an option overlay', [create_parms_dict=Create_parms_dict,
+								     create_parms_sent=Create_parms_sent,
+								     create_parms_opts=Create_parms_opts,
+								     handle('Dictionary')=_Handle_dict,
+								     handle('Sentence')=_Handle_sent,
+								     handle('Parse Options')=_Handle_opts,
+								     handle('Linkage Set')=_Handle_link,
+								     num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'reparse from a failed null count', [create_parms_dict=Create_parms_dict,
+									create_parms_sent=Create_parms_sent,
+									create_parms_opts=Create_parms_opts,
+									handle('Dictionary')=_Handle_dict,
+									handle('Sentence')=_Handle_sent,
+									handle('Parse Options')=_Handle_opts,
+									handle('Linkage Set')=_Handle_link]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_null_links(Create_parms_sent),
+	create_parms_parse_options_null_links(Create_parms_opts).
+scheduled_test_name('Linkage Set', 'two linkage sets on one sentence', [create_parms_dict=Create_parms_dict,
+									create_parms_sent=Create_parms_sent,
+									create_parms_opts=Create_parms_opts,
+									handle('Dictionary')=_Handle_dict,
+									handle('Sentence')=_Handle_sent,
+									handle('Parse Options')=_Handle_opts,
+									handle('Linkage Set')=_Handle_link,
+									num_linkage_expected=Number_linkage]):-
+	create_parms_dictionary(Create_parms_dict),
+	create_parms_sentence_multiple_linkages(Create_parms_sent, Number_linkage),
+	create_parms_parse_options_normal(Create_parms_opts).
 %scheduled_test_name('Dictionary', 'multiple creation/deletion', [base=dictionary]).
 
 
@@ -230,6 +454,619 @@ execute_test_name('Normal use', 'get linkage for one sentence', Parms, Indent):-
 	length(List_links, Number_of_linkages),
 	member(num_linkage_expected=Number_of_linkages, Parms).
 
+execute_test_name('Normal use', 'get all linkages for one sentence', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	member(num_linkage_expected=Number_of_linkages, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	findall(One_link, lgp_lib:get_linkage(Handle_link, One_link), List_links),
+	lgp_lib:get_all_linkages(Handle_link, List_all_links),
+	(   List_all_links =@= List_links
+	->  true
+	;   sformat(Exc_text, 'get_all_linkages/2 returned ~w whereas get_linkage/2 enumerates ~w~n', [List_all_links, List_links]),
+	    throw(test_fail(Exc_text))
+	),
+	length(List_all_links, Number_of_linkages),
+	nth0(1, List_links, Second_link),
+	lgp_lib:get_linkages(Handle_link, 1, 1, [Second_link_extracted]),
+	Second_link_extracted =@= Second_link,
+	lgp_lib:get_linkages(Handle_link, Number_of_linkages, 1, []),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'get linkage with string output format', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Linkage_default)),
+	once(lgp_lib:get_linkage(Handle_link, [word_format(string), connector_format(string)], Linkage_string)),
+	length(Linkage_default, Number_of_links),
+	length(Linkage_string, Number_of_links),
+	(   forall(member(link(_Domains, connection(Connector, w(Left_index, Left_word, _Left_type), w(Right_index, Right_word, _Right_type))), Linkage_string),
+		   (   string(Connector),
+		       integer(Left_index), integer(Right_index), Left_index < Right_index,
+		       string(Left_word), string(Right_word)
+		   ))
+	->  true
+	;   sformat(Exc_text, 'Unexpected linkage ~w with string output format~n', [Linkage_string]),
+	    throw(test_fail(Exc_text))
+	),
+	memberchk(link(_, connection(_, w(_, "software", n), _)), Linkage_string),
+	lgp_lib:get_all_linkages(Handle_link, [word_format(string), connector_format(string)], [Linkage_string_batch]),
+	Linkage_string_batch =@= Linkage_string,
+	set_prolog_flag(exception_raised, false),
+	catch(
+	      lgp_lib:get_linkage(Handle_link, [word_format(unknown)], _),
+	      lgp_api_error(output_options, bad_option),
+	      set_prolog_flag(exception_raised, true)
+	     ),
+	current_prolog_flag(exception_raised, true),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'get linkage in compact format', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	member(num_linkage_expected=Number_of_linkages, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	findall(Compact_linkage, lgp_lib:get_linkage_compact(Handle_link, Compact_linkage), Compact_linkages),
+	length(Compact_linkages, Number_of_linkages),
+	lgp_lib:get_all_linkages(Handle_link, [connector_format(string)], Linkages),
+	(   forall(nth0(Index, Compact_linkages, compact(Words, Links)),
+		   (   nth0(Index, Linkages, Linkage),
+		       length(Linkage, Number_of_links),
+		       length(Links, Number_of_links),
+		       functor(Words, words, Number_of_words),
+		       forall(member(l(Left_index, Right_index, Label_id, Domain_mask), Links),
+			      (	  Left_index < Right_index, Right_index < Number_of_words,
+				  integer(Domain_mask),
+				  lgp_lib:connector_label(Label_id, Label),
+				  memberchk(link(_, connection(Label, _, _)), Linkage),
+				  lgp_lib:connector_label(Label_id_back, Label),
+				  Label_id_back == Label_id
+			      ))
+		   )),
+	    \+ lgp_lib:connector_label(_, "ZZunknown") % Reverse look-up of a label never output: no id is allocated for it
+	->  true
+	;   sformat(Exc_text, 'Compact linkages ~w do not match linkages ~w~n', [Compact_linkages, Linkages]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'get best linkages', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	member(num_linkage_expected=Number_of_linkages, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	lgp_lib:get_all_linkages(Handle_link, All_linkages),
+	lgp_lib:get_best_linkages(Handle_link, 0, []),
+	lgp_lib:get_best_linkages(Handle_link, 1, [Best_linkage]),
+	(   member(One_linkage, All_linkages), One_linkage =@= Best_linkage
+	->  true
+	;   sformat(Exc_text, 'Best linkage ~w is not one of the linkages of the linkage set~n', [Best_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	Number_of_linkages_plus_one is Number_of_linkages + 1,
+	lgp_lib:get_best_linkages(Handle_link, Number_of_linkages_plus_one, Best_linkages),
+	length(Best_linkages, Number_of_linkages),
+	Best_linkages = [First_best_linkage|_],
+	First_best_linkage =@= Best_linkage,
+	forall(member(One_linkage, All_linkages), (member(One_best_linkage, Best_linkages), One_best_linkage =@= One_linkage)),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'get linkage with field projection', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Linkage_full)),
+	once(lgp_lib:get_linkage(Handle_link, [fields([words, labels])], Linkage_projected)),
+	length(Linkage_full, Number_of_links),
+	length(Linkage_projected, Number_of_links),
+	(   forall(nth1(Index, Linkage_projected, link(Domains, connection(Connector, Left_word, Right_word))),
+		   (   var(Domains),
+		       nth1(Index, Linkage_full, link(_, connection(Connector, Left_word, Right_word)))
+		   ))
+	->  true
+	;   sformat(Exc_text, 'Projected linkage ~w does not match linkage ~w~n', [Linkage_projected, Linkage_full]),
+	    throw(test_fail(Exc_text))
+	),
+	once(lgp_lib:get_linkage(Handle_link, [format(compact), fields([labels])], compact(Words, Links))),
+	(   var(Words),
+	    forall(member(l(_, _, Label_id, Domain_mask), Links), (integer(Label_id), var(Domain_mask)))
+	->  true
+	;   sformat(Exc_text, 'Unexpected projected compact linkage ~w~n', [compact(Words, Links)]),
+	    throw(test_fail(Exc_text))
+	),
+	set_prolog_flag(exception_raised, false),
+	catch(
+	      lgp_lib:get_linkage(Handle_link, [fields([subscripts])], _),
+	      lgp_api_error(output_options, bad_option),
+	      set_prolog_flag(exception_raised, true)
+	     ),
+	current_prolog_flag(exception_raised, true),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'parse without post-processing', Parms, Indent):-
+	!,
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	lgp_lib:create_dictionary([post_process(false), constituents(false)], Handle_dict),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Linkage)),
+	(   Linkage \== [],
+	    forall(member(link(Domains, connection(Connector, Left_word, Right_word)), Linkage),
+		   (   var(Domains), nonvar(Connector), nonvar(Left_word), nonvar(Right_word)
+		   ))
+	->  true
+	;   sformat(Exc_text, 'Unexpected linkage ~w without post-processing~n', [Linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Normal use', 'same links with and without post-processing knowledge', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict_pp], Indent),
+	lgp_lib:create_dictionary([post_process(false)], Handle_dict_raw),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict_pp], handle=Handle_sent_pp], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict_raw], handle=Handle_sent_raw], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent_pp, Handle_opts], handle=Handle_link_pp], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent_raw, Handle_opts], handle=Handle_link_raw], Indent),
+	once(lgp_lib:get_linkage(Handle_link_pp, Linkage_pp)),
+	once(lgp_lib:get_linkage(Handle_link_raw, Linkage_raw)),
+	(   Linkage_pp \== [],
+	    forall(member(link(Domains, _), Linkage_pp), nonvar(Domains)),
+	    forall(member(link(Domains, _), Linkage_raw), var(Domains)),
+	    findall(Connection, member(link(_, Connection), Linkage_pp), Connections_pp),
+	    findall(Connection, member(link(_, Connection), Linkage_raw), Connections_raw),
+	    Connections_pp =@= Connections_raw
+	->  true
+	;   sformat(Exc_text, 'Linkage ~w with post-processing and linkage ~w without it don''t match~n', [Linkage_pp, Linkage_raw]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link_pp], Indent),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link_raw], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_pp], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_raw], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict_pp], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict_raw], Indent).
+
+execute_test_name('Normal use', 'parse with worker processes', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_long_sent=Create_parm_long_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Expected_linkage)),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	% Workers estimate the cost of the sentences with the default parse options
+	go('Parse Options', 'creation of one object', [create_parms=[[]], handle=Handle_default_opts], Indent),
+	lgp_lib:estimate_parse_cost(Handle_sent, Handle_default_opts, Estimate),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_long_sent, Handle_dict], handle=Handle_long_sent], Indent),
+	lgp_lib:estimate_parse_cost(Handle_long_sent, Handle_default_opts, Long_estimate),
+	memberchk(cost_class=Expected_class, Estimate),
+	memberchk(cost_class=Expected_long_class, Long_estimate),
+	go('Sentence', 'deletion of one object', [handle=Handle_long_sent], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_default_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	lgp_lib:start_workers(2, Handle_dict),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent), % Workers keep the dictionary loaded
+	lgp_lib:worker_parse_batch([Create_parm_sent, Create_parm_sent, Create_parm_sent], [cost_classes(Classes)], Linkage_lists),
+	lgp_lib:worker_parse_batch([Create_parm_long_sent, Create_parm_sent], [cost_lanes(true), cost_classes(Lane_classes)], Lane_linkage_lists),
+	lgp_lib:stop_workers,
+	(   Linkage_lists = [[Linkage1|_], [Linkage2|_], [Linkage3|_]],
+	    Linkage1 =@= Expected_linkage, Linkage2 =@= Expected_linkage, Linkage3 =@= Expected_linkage,
+	    Lane_linkage_lists = [_, [Linkage4|_]],
+	    Linkage4 =@= Expected_linkage
+	->  true
+	;   sformat(Exc_text, 'Unexpected linkages ~w from worker processes, expected ~w~n', [Linkage_lists, Expected_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	(   Classes == [unknown, unknown, unknown], % No cost lanes, so no estimate
+	    Lane_classes == [Expected_long_class, Expected_class]
+	->  true
+	;   sformat(Exc_text, 'Unexpected cost classes ~w and ~w from worker processes, expected ~w~n', [Classes, Lane_classes, [Expected_long_class, Expected_class]]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'restart of a crashed worker', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	lgp_lib:start_workers(1, Handle_dict),
+	lgp_lib:get_worker_pids([Pid]),
+	process_kill(Pid, stop), % The job is sent to the worker but can't be answered before the worker is killed
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, normal, none, Crashed_job),
+	process_kill(Pid, kill),
+	catch((lgp_lib:parse_wait(Crashed_job, _), Crash_error = none), lgp_api_error(Object, Reason), Crash_error = lgp_api_error(Object, Reason)),
+	lgp_lib:get_worker_pids([Restarted_pid]),
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, normal, none, Job),
+	lgp_lib:parse_wait(Job, [Linkage|_]),
+	lgp_lib:worker_parse_batch([Create_parm_sent], [[Batch_linkage|_]]),
+	lgp_lib:stop_workers,
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	(   Crash_error == lgp_api_error(sentence, worker_crashed),
+	    Restarted_pid \== Pid,
+	    Linkage =@= Batch_linkage
+	->  true
+	;   sformat(Exc_text, 'Unexpected crash error ~w (worker ~w restarted as ~w), linkages ~w and ~w~n', [Crash_error, Pid, Restarted_pid, Linkage, Batch_linkage]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'parse on an lgp-server', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	member(nb_sentences=Nb_sentences, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Expected_linkage)),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	Socket_path = 'lgp_lib_test.socket',
+	Create_parm_dict = [Dict_file, Pp_file, Cons_file, Affix_file],
+	process_create('./lgp-server', ['-w', '2', Socket_path, Dict_file, Pp_file, Cons_file, Affix_file], [process(Pid)]),
+	call_cleanup(
+		     (	 connect_to_server(Socket_path, 50, Connection),
+			 call_cleanup(
+				      (	  once(lgp_remote:parse(Connection, Create_parm_sent, Remote_linkage)),
+					  length(Sentence_list, Nb_sentences),
+					  maplist(=(Create_parm_sent), Sentence_list),
+					  lgp_remote:parse_batch(Connection, Sentence_list, Linkage_lists)
+				      ),
+				      lgp_remote:disconnect(Connection))
+		     ),
+		     (	 process_kill(Pid, term),
+			 process_wait(Pid, _)
+		     )),
+	(   Remote_linkage =@= Expected_linkage,
+	    length(Linkage_lists, Nb_sentences),
+	    forall(member(Linkage_list, Linkage_lists), (Linkage_list = [Linkage|_], Linkage =@= Expected_linkage))
+	->  true
+	;   sformat(Exc_text, 'Unexpected linkages ~w from lgp-server, expected ~w~n', [Remote_linkage, Expected_linkage]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'stealing of expensive batch sentences', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_long_sent=Create_parm_long_sent, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	% Workers estimate the cost of the sentences with the default parse options
+	go('Parse Options', 'creation of one object', [create_parms=[[]], handle=Handle_default_opts], Indent),
+	expensive_sentence(Create_parm_long_sent, 2, Handle_dict, Handle_default_opts, Expensive_sent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_default_opts], Indent),
+	lgp_lib:start_workers(2, Handle_dict),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	lgp_lib:get_parse_queue_statistics(Statistics_before),
+	% The last worker takes the first expensive sentence, the other one must steal the others instead of idling
+	lgp_lib:worker_parse_batch([Expensive_sent, Expensive_sent, Expensive_sent], [cost_lanes(true), cost_classes(Classes)], Linkage_lists),
+	lgp_lib:get_parse_queue_statistics(Statistics_after),
+	lgp_lib:stop_workers,
+	(   Classes == [expensive, expensive, expensive],
+	    length(Linkage_lists, 3),
+	    memberchk(normal=Statistics_normal_before, Statistics_before),
+	    memberchk(stolen=Stolen_before, Statistics_normal_before),
+	    memberchk(normal=Statistics_normal_after, Statistics_after),
+	    memberchk(stolen=Stolen_after, Statistics_normal_after),
+	    Stolen_after > Stolen_before
+	->  true
+	;   sformat(Exc_text, 'No expensive sentence stolen (cost classes ~w, statistics ~w then ~w)~n', [Classes, Statistics_before, Statistics_after]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'parse jobs with priorities', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent, Handle_opts], handle=Handle_link], Indent),
+	once(lgp_lib:get_linkage(Handle_link, Expected_linkage)),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent], Indent),
+	lgp_lib:start_workers(2, Handle_dict),
+	lgp_lib:set_parse_class_limit(bulk, 1), % One worker is kept for the other classes
+	findall(Bulk_job, (between(1, 3, _), lgp_lib:parse_submit(Create_parm_sent, Handle_opts, bulk, none, Bulk_job)), Bulk_jobs),
+	get_time(Now),
+	Deadline is Now+60,
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, interactive, Deadline, Interactive_job),
+	lgp_lib:parse_wait(Interactive_job, [Interactive_linkage|_]),
+	findall(Bulk_linkage, (member(Bulk_job, Bulk_jobs), lgp_lib:parse_wait(Bulk_job, [Bulk_linkage|_])), Bulk_linkages),
+	lgp_lib:get_parse_queue_statistics(Statistics),
+	lgp_lib:set_parse_class_limit(bulk, 16),
+	lgp_lib:stop_workers,
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	(   Interactive_linkage =@= Expected_linkage,
+	    Bulk_linkages = [Linkage1, Linkage2, Linkage3],
+	    Linkage1 =@= Expected_linkage, Linkage2 =@= Expected_linkage, Linkage3 =@= Expected_linkage
+	->  true
+	;   sformat(Exc_text, 'Unexpected linkages ~w and ~w from parse jobs, expected ~w~n', [Interactive_linkage, Bulk_linkages, Expected_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	(   memberchk(bulk=Bulk_statistics, Statistics),
+	    memberchk(queued=0, Bulk_statistics),
+	    memberchk(running=0, Bulk_statistics),
+	    memberchk(max_queued=Max_queued, Bulk_statistics), Max_queued >= 2,
+	    memberchk(stolen=0, Bulk_statistics), % Only the expensive sentences of worker_parse_batch/3 can be stolen
+	    memberchk(interactive=Interactive_statistics, Statistics),
+	    memberchk(completed=Completed, Interactive_statistics), Completed >= 1
+	->  true
+	;   sformat(Exc_text, 'Unexpected parse queue statistics ~w~n', [Statistics]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'preemption of a bulk job', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	lgp_lib:start_workers(1, Handle_dict),
+	lgp_lib:get_parse_queue_statistics(Statistics_before),
+	lgp_lib:get_worker_pids([Pid]),
+	process_kill(Pid, stop), % The bulk job keeps the only worker busy until it is preempted
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, bulk, none, Bulk_job),
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, interactive, none, Interactive_job),
+	lgp_lib:parse_wait(Interactive_job, [Interactive_linkage|_]),
+	lgp_lib:parse_wait(Bulk_job, [Bulk_linkage|_]),
+	lgp_lib:get_parse_queue_statistics(Statistics_after),
+	lgp_lib:stop_workers,
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	(   Bulk_linkage =@= Interactive_linkage,
+	    memberchk(bulk=Bulk_statistics_before, Statistics_before),
+	    memberchk(preempted=Preempted_before, Bulk_statistics_before),
+	    memberchk(bulk=Bulk_statistics_after, Statistics_after),
+	    memberchk(preempted=Preempted_after, Bulk_statistics_after), Preempted_after > Preempted_before,
+	    memberchk(running=0, Bulk_statistics_after),
+	    memberchk(queued=0, Bulk_statistics_after)
+	->  true
+	;   sformat(Exc_text, 'Unexpected preemption results (linkages ~w and ~w, statistics ~w then ~w)~n', [Bulk_linkage, Interactive_linkage, Statistics_before, Statistics_after]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'parse through a pipeline', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	lgp_lib:start_workers(2, Handle_dict),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	lgp_lib:worker_parse_batch([Create_parm_sent], [Expected_linkages]),
+	lgp_lib:create_pipeline([capacity(2), when_full(fail)], Pipeline),
+	lgp_lib:pipeline_push(Pipeline, Create_parm_sent),
+	lgp_lib:pipeline_push(Pipeline, Create_parm_sent),
+	(   lgp_lib:pipeline_push(Pipeline, Create_parm_sent)
+	->  Full_push = succeeded
+	;   Full_push = failed
+	),
+	lgp_lib:pipeline_pop(Pipeline, Linkages1),
+	lgp_lib:pipeline_push(Pipeline, Create_parm_sent), % Space has been given back by pipeline_pop/2
+	lgp_lib:close_pipeline(Pipeline),
+	findall(Linkages, lgp_lib:pipeline_pop(Pipeline, Linkages), Remaining_linkages),
+	lgp_lib:delete_pipeline(Pipeline),
+	lgp_lib:stop_workers,
+	(   Full_push == failed,
+	    Remaining_linkages = [Linkages2, Linkages3],
+	    Linkages1 =@= Expected_linkages, Linkages2 =@= Expected_linkages, Linkages3 =@= Expected_linkages
+	->  true
+	;   sformat(Exc_text, 'Unexpected pipeline results (push on full pipeline ~w, linkages ~w and ~w), expected ~w~n', [Full_push, Linkages1, Remaining_linkages, Expected_linkages]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'blocking push on a full pipeline', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	lgp_lib:start_workers(1, Handle_dict),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	lgp_lib:worker_parse_batch([Create_parm_sent], [Expected_linkages]),
+	lgp_lib:create_pipeline([capacity(1), when_full(block)], Pipeline),
+	message_queue_create(Queue),
+	lgp_lib:pipeline_push(Pipeline, Create_parm_sent),
+	% A second producer thread must wait on the full pipeline until the main thread pops a sentence
+	thread_create(push_from_thread(Pipeline, Create_parm_sent, Queue), Producer1, []),
+	(   thread_get_message(Queue, _, [timeout(0.5)])
+	->  Blocked = false
+	;   Blocked = true
+	),
+	lgp_lib:pipeline_pop(Pipeline, Linkages1),
+	(   thread_get_message(Queue, After_pop, [timeout(10)]) -> true ; After_pop = timeout ),
+	thread_join(Producer1, _),
+	% A producer waiting on the full pipeline can be interrupted by a signal
+	thread_create(push_from_thread(Pipeline, Create_parm_sent, Queue), Producer2, []),
+	sleep(0.5),
+	thread_signal(Producer2, throw(stop_push)),
+	(   thread_get_message(Queue, After_signal, [timeout(10)]) -> true ; After_signal = timeout ),
+	thread_join(Producer2, _),
+	lgp_lib:pipeline_pop(Pipeline, Linkages2),
+	lgp_lib:close_pipeline(Pipeline),
+	lgp_lib:delete_pipeline(Pipeline),
+	message_queue_destroy(Queue),
+	lgp_lib:stop_workers,
+	(   Blocked == true,
+	    After_pop == pushed,
+	    After_signal == interrupted,
+	    Linkages1 =@= Expected_linkages, Linkages2 =@= Expected_linkages
+	->  true
+	;   sformat(Exc_text, 'Unexpected blocking pipeline results (push blocked ~w, then ~w after a pop and ~w after a signal, linkages ~w and ~w), expected ~w~n',
+		    [Blocked, After_pop, After_signal, Linkages1, Linkages2, Expected_linkages]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'interrupted waits for the workers', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	lgp_lib:start_workers(1, Handle_dict),
+	lgp_lib:worker_parse_batch([Create_parm_sent], [Expected_linkages]),
+	lgp_lib:get_worker_pids([Pid]),
+	process_kill(Pid, stop), % The worker doesn't answer until it is continued
+	message_queue_create(Queue),
+	% A thread waiting for a parse job can be interrupted by a signal, the job being kept
+	lgp_lib:parse_submit(Create_parm_sent, Handle_opts, normal, none, Job),
+	thread_create(call_from_thread(lgp_lib:parse_wait(Job, _), Queue), Waiter, []),
+	sleep(0.5),
+	thread_signal(Waiter, throw(stop_wait)),
+	(   thread_get_message(Queue, After_signal, [timeout(10)]) -> true ; After_signal = timeout ),
+	thread_join(Waiter, _),
+	% A consumer waiting for the parse of a sentence gets bad_handle if its pipeline is deleted meanwhile
+	lgp_lib:create_pipeline([capacity(1)], Pipeline),
+	lgp_lib:pipeline_push(Pipeline, Create_parm_sent),
+	thread_create(call_from_thread(lgp_lib:pipeline_pop(Pipeline, _), Queue), Consumer, []),
+	sleep(0.5),
+	lgp_lib:delete_pipeline(Pipeline),
+	process_kill(Pid, cont),
+	(   thread_get_message(Queue, After_delete, [timeout(10)]) -> true ; After_delete = timeout ),
+	thread_join(Consumer, _),
+	lgp_lib:parse_wait(Job, Linkages),
+	message_queue_destroy(Queue),
+	lgp_lib:stop_workers,
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	(   After_signal == interrupted,
+	    After_delete == lgp_api_error(pipeline, bad_handle),
+	    Linkages =@= Expected_linkages
+	->  true
+	;   sformat(Exc_text, 'Unexpected results of interrupted waits (~w after a signal, ~w after the deletion of the pipeline, linkages ~w), expected ~w~n',
+		    [After_signal, After_delete, Linkages, Expected_linkages]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'concurrent parses from several threads', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	member(num_linkage_expected=Number_of_linkages, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	parse_from_thread(Create_parm_sent, Handle_dict, Handle_opts, 1, Expected_results),
+	% The library mutex serializes the foreign predicates, so that threads parsing at the same time with a shared dictionary must get the same linkages as a single thread
+	message_queue_create(Queue),
+	findall(Thread,
+		(   between(1, 4, _),
+		    thread_create(( parse_from_thread(Create_parm_sent, Handle_dict, Handle_opts, 5, Results),
+				    thread_send_message(Queue, Results)
+				  ), Thread, [])
+		), Threads),
+	findall(Results, ( member(_, Threads), ( thread_get_message(Queue, Results, [timeout(60)]) -> true ; Results = timeout ) ), Thread_results),
+	maplist(thread_join, Threads, _),
+	message_queue_destroy(Queue),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent),
+	(   Expected_results = [Expected_linkages],
+	    length(Expected_linkages, Number_of_linkages),
+	    forall(member(Results, Thread_results),
+		   (   is_list(Results), length(Results, 5),
+		       forall(member(Linkages, Results), Linkages =@= Expected_linkages)
+		   ))
+	->  true
+	;   sformat(Exc_text, 'Unexpected results of concurrent parses ~w, expected ~w~n', [Thread_results, Expected_results]),
+	    throw(test_fail(Exc_text))
+	).
+
+execute_test_name('Normal use', 'parse session', Parms, _Indent):-
+	!,
+	member(create_parms_dict=[Dict_file, Pp_file, Cons_file, Affix_file], Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	Counts=[lgp_lib:get_nb_dictionaries(_), lgp_lib:get_nb_parse_options(_), lgp_lib:get_nb_sentences(_), lgp_lib:get_nb_linkage_sets(_)],
+	copy_term(Counts, Counts_before), maplist(call, Counts_before),
+	lgp_lib:with_parse_session(( lgp_lib:create_dictionary(Dict_file, Pp_file, Cons_file, Affix_file, Handle_dict),
+				     lgp_lib:create_sentence(Create_parm_sent, Handle_dict, Handle_sent),
+				     lgp_lib:create_parse_options(Create_parm_opts, Handle_opts),
+				     lgp_lib:create_linkage_set(Handle_sent, Handle_opts, Handle_link),
+				     lgp_lib:get_linkage(Handle_link, _)
+				   )),
+	copy_term(Counts, Counts_after), maplist(call, Counts_after),
+	(   Counts_after == Counts_before
+	->  true
+	;   sformat(Exc_text, 'Objects left after a parse session: ~w, expected ~w~n', [Counts_after, Counts_before]),
+	    throw(test_fail(Exc_text))
+	),
+	catch(lgp_lib:with_parse_session(( lgp_lib:create_dictionary(Dict_file, Pp_file, Cons_file, Affix_file, _),
+					   throw(session_aborted)
+					 )),
+	      session_aborted,
+	      true),
+	copy_term(Counts, Counts_after_exception), maplist(call, Counts_after_exception),
+	(   Counts_after_exception == Counts_before
+	->  true
+	;   sformat(Exc_text, 'Objects left after an aborted parse session: ~w, expected ~w~n', [Counts_after_exception, Counts_before]),
+	    throw(test_fail(Exc_text))
+	).
+
 execute_test_name('Normal use', 'sample creation of two linkage sets', Parms, Indent):-
 	!,
 	get_nb_parse_options(Nb_parse_options_original),
@@ -489,6 +1326,49 @@ execute_test_name(Type_of_item, 'handles, references and count check', _Parms, _
 	),
 	true.
 
+execute_test_name('Sentence', 'creation from string and code list', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	Create_parm_dict = [Dict_name, Pp_knowledge_name, Cons_knowledge_name, Affix_name],
+	atom_string(Dict_name, Dict_name_string),
+	atom_codes(Affix_name, Affix_name_codes),
+	go('Dictionary', 'creation of one object', [create_parms=[Dict_name_string, Pp_knowledge_name, Cons_knowledge_name, Affix_name_codes], handle=Handle_dict], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	atom_string(Create_parm_sent, Sentence_string),
+	atom_codes(Create_parm_sent, Sentence_codes),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent_atom], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Sentence_string, Handle_dict], handle=Handle_sent_string], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Sentence_codes, Handle_dict], handle=Handle_sent_codes], Indent),
+	lgp_lib:create_linkage_set(Handle_sent_atom, Handle_opts, Handle_link_atom),
+	lgp_lib:create_linkage_set(Handle_sent_string, Handle_opts, Handle_link_string),
+	lgp_lib:create_linkage_set(Handle_sent_codes, Handle_opts, Handle_link_codes),
+	lgp_lib:get_all_linkages(Handle_link_atom, Linkages_atom),
+	lgp_lib:get_all_linkages(Handle_link_string, Linkages_string),
+	lgp_lib:get_all_linkages(Handle_link_codes, Linkages_codes),
+	(   Linkages_string =@= Linkages_atom,
+	    Linkages_codes =@= Linkages_atom
+	->  true
+	;   sformat(Exc_text, 'Sentences created from an atom, a string and a code list give different linkages~n', []),
+	    throw(test_fail(Exc_text))
+	),
+	set_prolog_flag(exception_raised, false),
+	catch(
+	      lgp_lib:create_sentence(_Unbound_text, Handle_dict, _),
+	      lgp_api_error(sentence, instanciation_fault),
+	      set_prolog_flag(exception_raised, true)
+	     ),
+	current_prolog_flag(exception_raised, true),
+	lgp_lib:delete_linkage_set(Handle_link_atom),
+	lgp_lib:delete_linkage_set(Handle_link_string),
+	lgp_lib:delete_linkage_set(Handle_link_codes),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_atom], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_string], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_codes], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
 execute_test_name('Sentence', 'deletion of non-existing handle', Parms, Indent):-
 	set_prolog_flag(exception_raised, false),
 	lgp_lib: get_handles_sentences(List_H),
@@ -587,6 +1467,274 @@ execute_test_name('Linkage Set', 'deletion of linkage set object before cut of g
 	go('Sentence', 'context deletion of one object', Parms, Indent),
 	go('Parse Options', 'context deletion of one object', Parms, Indent).
 
+execute_test_name('Dictionary', 'reload', Parms, Indent):-
+	!,
+	member(create_parms_dict=Create_parm_dict, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	go('Dictionary', 'creation of one object', [create_parms=Create_parm_dict, handle=Handle_dict], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent_before], Indent),
+	lgp_lib:reload_dictionary(Handle_dict),
+	go('Dictionary', 'verification of reference count', [handle=Handle_dict, ref_count=1], Indent),
+	go('Sentence', 'creation of one object', [create_parms=[Create_parm_sent, Handle_dict], handle=Handle_sent_after], Indent),
+	go('Parse Options', 'creation of one object', [create_parms=[Create_parm_opts], handle=Handle_opts], Indent),
+	% The sentence created before the reload still uses the previous dictionary, both must give the same linkage
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent_before, Handle_opts], handle=Handle_link_before], Indent),
+	go('Linkage Set', 'creation of one object', [create_parms=[Handle_sent_after, Handle_opts], handle=Handle_link_after], Indent),
+	lgp_lib:get_all_linkages(Handle_link_before, Linkages_before),
+	lgp_lib:get_all_linkages(Handle_link_after, Linkages_after),
+	(   Linkages_before =@= Linkages_after
+	->  true
+	;   sformat(Exc_text, 'Linkages ~w before reload differ from linkages ~w after reload~n', [Linkages_before, Linkages_after]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link_before], Indent),
+	go('Linkage Set', 'deletion of one object', [handle=Handle_link_after], Indent),
+	go('Parse Options', 'deletion of one object', [handle=Handle_opts], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_before], Indent),
+	go('Sentence', 'deletion of one object', [handle=Handle_sent_after], Indent),
+	go('Dictionary', 'deletion of one object', [handle=Handle_dict], Indent).
+
+execute_test_name('Linkage Set', 'statistics', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	lgp_lib:get_linkage_set_statistics(Handle_link, Statistics),
+	memberchk(parse_time=Parse_time, Statistics),
+	(   number(Parse_time), Parse_time >= 0
+	->  true
+	;   sformat(Exc_text, 'Invalid parse time ~w in statistics ~w~n', [Parse_time, Statistics]),
+	    throw(test_fail(Exc_text))
+	),
+	memberchk(valid_linkages=Number_linkage, Statistics),
+	memberchk(linkages_found=Linkages_found, Statistics),
+	Linkages_found >= Number_linkage,
+	memberchk(null_count=0, Statistics),
+	memberchk(timer_expired=false, Statistics),
+	memberchk(memory_exhausted=false, Statistics),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'nested get_linkage calls', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	findall(Linkage1-Linkage2, (get_linkage(Handle_link, Linkage1), get_linkage(Handle_link, Linkage2)), Pairs),
+	length(Pairs, Nb_pairs),
+	once((get_linkage(Handle_link, _), get_linkage(Handle_link, _), get_linkage(Handle_link, _))), % Cut three contexts of the same linkage set at once
+	(   Nb_pairs =:= Number_linkage*Number_linkage
+	->  true
+	;   sformat(Exc_text, 'Nested get_linkage/2 calls returned ~w pairs of linkages, expected ~w~n', [Nb_pairs, Number_linkage*Number_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'reparse with an option overlay', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Sentence')=Handle_sent, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	get_nb_parse_options(Nb_parse_options_before),
+	lgp_lib:reparse_linkage_set(Handle_link, [max_null_count=3, linkage_limit=50], Handle_new_link),
+	get_num_linkages(Handle_new_link, Number_new_linkage),
+	get_parameters_for_linkage_set(Handle_new_link, New_parameters),
+	memberchk(sentence_handle=Handle_new_sent, New_parameters),
+	memberchk(parse_options_handle=Handle_new_opts, New_parameters),
+	lgp_lib:get_linkage_set_statistics(Handle_new_link, New_statistics),
+	memberchk(null_count=New_null_count, New_statistics),
+	get_nb_parse_options(Nb_parse_options_after), % The parse options of the new linkage set are private
+	delete_linkage_set(Handle_new_link),
+	create_parse_options(Create_parm_opts, Handle_fresh_opts),
+	set_parse_options(Handle_fresh_opts, [max_null_count=3, linkage_limit=50]),
+	create_linkage_set(Handle_sent, Handle_fresh_opts, Handle_fresh_link),
+	get_num_linkages(Handle_fresh_link, Number_fresh_linkage),
+	delete_linkage_set(Handle_fresh_link),
+	delete_parse_options(Handle_fresh_opts),
+	(   Handle_new_sent == Handle_sent,
+	    Handle_new_opts == none,
+	    Number_new_linkage =:= Number_linkage,
+	    Number_new_linkage =:= Number_fresh_linkage,
+	    New_null_count =:= 0,
+	    Nb_parse_options_after =:= Nb_parse_options_before
+	->  true
+	;   sformat(Exc_text, 'Unexpected reparse result (sentence ~w, ~w linkages with null count ~w, ~w for a fresh parse, ~w parse options left out of ~w), expected sentence ~w and ~w linkages~n',
+		    [Handle_new_sent, Number_new_linkage, New_null_count, Number_fresh_linkage, Nb_parse_options_after, Nb_parse_options_before, Handle_sent, Number_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'reparse from a failed null count', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Dictionary')=Handle_dict, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(create_parms_sent=Create_parm_sent, Parms),
+	member(create_parms_opts=Create_parm_opts, Parms),
+	lgp_lib:get_linkage_set_statistics(Handle_link, Statistics),
+	memberchk(null_count=Null_count, Statistics),
+	% The null counts from min_null_count=0 to Null_count-1 are known to fail, the reparse starts from Null_count
+	lgp_lib:reparse_linkage_set(Handle_link, [min_null_count=0, max_null_count=100], Handle_new_link),
+	get_num_linkages(Handle_new_link, Number_new_linkage),
+	lgp_lib:get_linkage_set_statistics(Handle_new_link, New_statistics),
+	memberchk(null_count=New_null_count, New_statistics),
+	memberchk(linkages_found=New_linkages_found, New_statistics),
+	% The overlay is applied to a parse options object created for the time of the call: a reparse fails once the limit of parse options objects is reached
+	get_nb_parse_options(Nb_parse_options),
+	Nb_free_parse_options is 4 - Nb_parse_options, % NB_PARSE_OPTIONS in lgp.c
+	findall(Handle_filler_opts, (between(1, Nb_free_parse_options, _), create_parse_options(Create_parm_opts, Handle_filler_opts)), Handles_filler_opts),
+	set_prolog_flag(exception_raised, false),
+	catch(
+	      lgp_lib:reparse_linkage_set(Handle_new_link, [max_null_count=200], _),
+	      lgp_api_error(parse_options, too_many),
+	      set_prolog_flag(exception_raised, true)
+	     ),
+	current_prolog_flag(exception_raised, Exception_raised),
+	get_nb_parse_options(Nb_parse_options_full),
+	forall(member(Handle_filler_opts, Handles_filler_opts), delete_parse_options(Handle_filler_opts)),
+	delete_linkage_set(Handle_new_link),
+	% Full parse of the same text from a new sentence object, that knows no failed null count
+	lgp_lib:create_sentence(Create_parm_sent, Handle_dict, Handle_fresh_sent),
+	create_parse_options(Create_parm_opts, Handle_fresh_opts),
+	set_parse_options(Handle_fresh_opts, [min_null_count=0, max_null_count=100]),
+	create_linkage_set(Handle_fresh_sent, Handle_fresh_opts, Handle_fresh_link),
+	get_num_linkages(Handle_fresh_link, Number_fresh_linkage),
+	lgp_lib:get_linkage_set_statistics(Handle_fresh_link, Fresh_statistics),
+	memberchk(null_count=Fresh_null_count, Fresh_statistics),
+	memberchk(linkages_found=Fresh_linkages_found, Fresh_statistics),
+	delete_linkage_set(Handle_fresh_link),
+	delete_parse_options(Handle_fresh_opts),
+	delete_sentence(Handle_fresh_sent),
+	(   Null_count > 0,
+	    New_null_count =:= Null_count,
+	    Fresh_null_count =:= Null_count,
+	    Number_new_linkage =:= Number_fresh_linkage,
+	    New_linkages_found =:= Fresh_linkages_found
+	->  true
+	;   sformat(Exc_text, 'Reparse from null count ~w gave ~w linkages (~w found) with null count ~w, a full parse gave ~w linkages (~w found) with null count ~w~n',
+		    [Null_count, Number_new_linkage, New_linkages_found, New_null_count, Number_fresh_linkage, Fresh_linkages_found, Fresh_null_count]),
+	    throw(test_fail(Exc_text))
+	),
+	(   Exception_raised == true,
+	    Nb_parse_options_full =:= 4
+	->  true
+	;   sformat(Exc_text, 'Reparse with all the ~w parse options objects in use did not raise lgp_api_error(parse_options, too_many)~n', [Nb_parse_options_full]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'two linkage sets on one sentence', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Sentence')=Handle_sent, Parms),
+	member(handle('Parse Options')=Handle_opts, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	% Both linkage sets are alive and their linkages are requested in turn, each one must keep its own parse
+	create_linkage_set(Handle_sent, Handle_opts, Handle_second_link),
+	findall(Linkage1-Linkage2, (get_linkage(Handle_link, Linkage1), get_linkage(Handle_second_link, Linkage2)), Pairs),
+	length(Pairs, Nb_pairs),
+	lgp_lib:get_all_linkages(Handle_link, Linkages),
+	lgp_lib:get_all_linkages(Handle_second_link, Second_linkages),
+	delete_linkage_set(Handle_second_link),
+	lgp_lib:get_all_linkages(Handle_link, Linkages_after_deletion),
+	(   Nb_pairs =:= Number_linkage*Number_linkage,
+	    length(Linkages, Number_linkage),
+	    Second_linkages =@= Linkages,
+	    Linkages_after_deletion =@= Linkages
+	->  true
+	;   sformat(Exc_text, 'Two linkage sets on one sentence gave ~w pairs of linkages (~w expected), ~w and ~w, then ~w once the second one was deleted~n',
+		    [Nb_pairs, Number_linkage*Number_linkage, Linkages, Second_linkages, Linkages_after_deletion]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'sentence acceptance', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Sentence')=Handle_sent, Parms),
+	member(handle('Parse Options')=Handle_opts, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	lgp_lib:get_parse_options(Handle_opts, Options_before),
+	lgp_lib:sentence_accepts(Handle_sent, Handle_opts, Info),
+	lgp_lib:get_parse_options(Handle_opts, Options_after),
+	(   memberchk(accepted=true, Info),
+	    memberchk(null_count=0, Info),
+	    memberchk(disjunct_cost=Disjunct_cost, Info), integer(Disjunct_cost),
+	    memberchk(link_cost=Link_cost, Info), integer(Link_cost)
+	->  true
+	;   sformat(Exc_text, 'Unexpected acceptance info ~w~n', [Info]),
+	    throw(test_fail(Exc_text))
+	),
+	% The check runs on a private copy of the parse options (with a linkage_limit of 1)
+	(   Options_after == Options_before
+	->  true
+	;   sformat(Exc_text, 'sentence_accepts/3 changed the parse options from ~w to ~w~n', [Options_before, Options_after]),
+	    throw(test_fail(Exc_text))
+	),
+	% sentence_accepts/3 parsed the sentence apart, the linkage set must still give all its linkages
+	lgp_lib:get_all_linkages(Handle_link, Linkages),
+	(   length(Linkages, Number_linkage)
+	->  true
+	;   sformat(Exc_text, 'Linkage set gives ~w linkages after sentence_accepts/3, ~w expected~n', [Linkages, Number_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'memory budget', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Sentence')=Handle_sent, Parms),
+	member(handle('Parse Options')=Handle_opts, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	lgp_lib:get_parse_options(Handle_opts, Options),
+	memberchk(max_memory=Max_memory, Options),
+	lgp_lib:set_parse_options(Handle_opts, [max_memory=1]), % No parse can be done within such a budget
+	set_prolog_flag(exception_raised, false),
+	catch(
+	      lgp_lib:create_linkage_set(Handle_sent, Handle_opts, _),
+	      lgp_api_error(parse, memory_exceeded),
+	      set_prolog_flag(exception_raised, true)
+	     ),
+	current_prolog_flag(exception_raised, true),
+	lgp_lib:set_parse_options(Handle_opts, [max_memory=Max_memory]),
+	% The linkage set created within the budget must still give all its linkages
+	lgp_lib:get_all_linkages(Handle_link, Linkages),
+	(   length(Linkages, Number_linkage)
+	->  true
+	;   sformat(Exc_text, 'Linkage set gives ~w linkages after an aborted parse, ~w expected~n', [Linkages, Number_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
+execute_test_name('Linkage Set', 'parse cost estimate', Parms, Indent):-
+	!,
+	go('Linkage Set', 'context creation of one object', Parms, Indent),
+	member(handle('Sentence')=Handle_sent, Parms),
+	member(handle('Parse Options')=Handle_opts, Parms),
+	member(handle('Linkage Set')=Handle_link, Parms),
+	member(num_linkage_expected=Number_linkage, Parms),
+	lgp_lib:estimate_parse_cost(Handle_sent, Handle_opts, Estimate),
+	(   memberchk(words=Words, Estimate), integer(Words), Words > 0,
+	    memberchk(disjuncts=Disjuncts, Estimate), integer(Disjuncts), Disjuncts >= Words,
+	    memberchk(cost_class=Cost_class, Estimate), memberchk(Cost_class, [cheap, medium, expensive])
+	->  true
+	;   sformat(Exc_text, 'Unexpected parse cost estimate ~w~n', [Estimate]),
+	    throw(test_fail(Exc_text))
+	),
+	% The pruning run by estimate_parse_cost/3 must not alter the linkages of the linkage set
+	lgp_lib:get_all_linkages(Handle_link, Linkages),
+	(   length(Linkages, Number_linkage)
+	->  true
+	;   sformat(Exc_text, 'Linkage set gives ~w linkages after estimate_parse_cost/3, ~w expected~n', [Linkages, Number_linkage]),
+	    throw(test_fail(Exc_text))
+	),
+	go('Linkage Set', 'context deletion of one object', Parms, Indent).
+
 
 execute_test_name(Type_of_item, 'creation/deletion', Parms, Indent):-
 	!,
@@ -782,3 +1930,61 @@ execute_test_name('Dictionary', 'multiple creation/deletion'):-
 	true.
 
 	
+
+% connect_to_server(+Socket_path, +Nb_attempts, -Connection)
+% Connects to an lgp-server which has just been started, waiting for it to load its dictionary and open its socket
+connect_to_server(Socket_path, Nb_attempts, Connection):-
+	catch(lgp_remote:connect(Socket_path, Connection), Exc, true),
+	(   var(Exc)
+	->  true
+	;   Nb_attempts > 1
+	->  sleep(0.2),
+	    Next_nb_attempts is Nb_attempts-1,
+	    connect_to_server(Socket_path, Next_nb_attempts, Connection)
+	;   throw(Exc)
+	).
+
+% push_from_thread(+Pipeline, +Text, +Queue)
+% Pushes Text into Pipeline from another thread, then sends pushed to Queue, or interrupted if the push has been interrupted by thread_signal(Thread, throw(stop_push))
+push_from_thread(Pipeline, Text, Queue):-
+	catch(( lgp_lib:pipeline_push(Pipeline, Text),
+		Result = pushed
+	      ), stop_push, Result = interrupted),
+	thread_send_message(Queue, Result).
+
+% call_from_thread(+Goal, +Queue)
+% Calls Goal from another thread, then sends done (or failed) to Queue, or interrupted if Goal has been interrupted by thread_signal(Thread, throw(stop_wait)), or the exception raised by Goal
+call_from_thread(Goal, Queue):-
+	catch(( call(Goal) -> Result = done ; Result = failed ),
+	      Exception,
+	      (	  Exception == stop_wait -> Result = interrupted ; Result = Exception )),
+	thread_send_message(Queue, Result).
+
+% parse_from_thread(+Text, +Dictionary_handle, +Parse_options_handle, +Nb_parses, -Results)
+% Parses Text Nb_parses times, each time with a new sentence and linkage set, Results being the list of the linkages of each parse, or error(Exception) if a parse raised Exception
+parse_from_thread(Text, Handle_dict, Handle_opts, Nb_parses, Results):-
+	catch(findall(Linkages,
+		      (	  between(1, Nb_parses, _),
+			  lgp_lib:create_sentence(Text, Handle_dict, Handle_sent),
+			  lgp_lib:create_linkage_set(Handle_sent, Handle_opts, Handle_link),
+			  lgp_lib:get_all_linkages(Handle_link, Linkages),
+			  lgp_lib:delete_linkage_set(Handle_link),
+			  lgp_lib:delete_sentence(Handle_sent)
+		      ), Results),
+	      Exception, Results = error(Exception)).
+
+% expensive_sentence(+Text, +Nb_copies, +Dictionary_handle, +Parse_options_handle, -Expensive_text)
+% Expensive_text is made of as few copies of Text (at most Nb_copies, joined with "and") as needed for estimate_parse_cost/3 to predict an expensive parse
+expensive_sentence(Text, Nb_copies, Handle_dict, Handle_opts, Expensive_text):-
+	between(1, Nb_copies, Nb),
+	findall(Text, between(1, Nb, _), Copies),
+	atomic_list_concat(Copies, ' and ', Candidate),
+	lgp_lib:create_sentence(Candidate, Handle_dict, Handle_sent),
+	lgp_lib:estimate_parse_cost(Handle_sent, Handle_opts, Estimate),
+	lgp_lib:delete_sentence(Handle_sent),
+	memberchk(cost_class=expensive, Estimate),
+	!,
+	Expensive_text = Candidate.
+expensive_sentence(Text, Nb_copies, _, _, _):-
+	sformat(Exc_text, 'No expensive sentence made of at most ~w copies of ~w~n', [Nb_copies, Text]),
+	throw(test_fail(Exc_text)).